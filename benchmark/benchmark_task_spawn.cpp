@@ -1,11 +1,17 @@
+#include <asyncpp/inline_task.hpp>
 #include <asyncpp/join.hpp>
 #include <asyncpp/task.hpp>
 #include <asyncpp/threading/cache.hpp>
 
 #include <array>
+#include <atomic>
+#include <memory>
 #include <memory_resource>
+#include <string>
+#include <vector>
 
 #include <celero/Celero.h>
+#include <celero/UserDefinedMeasurementTemplate.h>
 
 
 using namespace asyncpp;
@@ -133,4 +139,99 @@ BENCHMARK_F(task_spawn, PMR_stack, FixtureStack, numSamples, numIterations) {
     }
     assert(ready);
     celero::DoNotOptimizeAway(ready);
+}
+
+
+// Frames are allocated through the rebound allocator, so the counter can't be a member of the template.
+struct counting_allocator_counters {
+    static inline std::atomic_size_t num_allocations = 0;
+};
+
+
+// Counts the coroutine frames that were actually allocated. When the compiler
+// applies heap allocation elision (HALO) to the awaited chain, this stays zero.
+template <class T = std::byte>
+struct counting_allocator : counting_allocator_counters {
+    using value_type = T;
+
+    counting_allocator() = default;
+
+    template <class U>
+    counting_allocator(const counting_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        num_allocations.fetch_add(1, std::memory_order_relaxed);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        std::allocator<T>().deallocate(ptr, n);
+    }
+};
+
+
+// Reports the coroutine frames allocated per chain, averaged over the iterations of a sample.
+struct FixtureAllocations : celero::TestFixture {
+    struct allocations : celero::UserDefinedMeasurementTemplate<size_t> {
+        std::string getName() const override {
+            return "allocations";
+        }
+    };
+
+    void setUp(const ExperimentValue*) override {
+        before = counting_allocator_counters::num_allocations.load(std::memory_order_relaxed);
+    }
+
+    void tearDown() override {
+        const auto after = counting_allocator_counters::num_allocations.load(std::memory_order_relaxed);
+        measurement->addValue((after - before) / numIterations);
+    }
+
+    std::vector<std::shared_ptr<celero::UserDefinedMeasurement>> getUserDefinedMeasurements() const override {
+        return { measurement };
+    }
+
+private:
+    size_t before = 0;
+    std::shared_ptr<allocations> measurement = std::make_shared<allocations>();
+};
+
+
+constexpr int chainDepth = 8;
+
+
+// Every link of the chain is a distinct function, as elision doesn't apply to recursive calls.
+template <int Depth>
+task<int, counting_allocator<>> task_chain() {
+    if constexpr (Depth == 0) {
+        co_return 0;
+    }
+    else {
+        co_return 1 + co_await task_chain<Depth - 1>();
+    }
+}
+
+
+template <int Depth>
+inline_task<int, counting_allocator<>> inline_task_chain() {
+    if constexpr (Depth == 0) {
+        co_return 0;
+    }
+    else {
+        co_return 1 + co_await inline_task_chain<Depth - 1>();
+    }
+}
+
+
+BASELINE_F(task_chain, task, FixtureAllocations, numSamples, numIterations) {
+    const auto result = join(task_chain<chainDepth>());
+    assert(result == chainDepth);
+    celero::DoNotOptimizeAway(result);
+}
+
+
+BENCHMARK_F(task_chain, inline_task, FixtureAllocations, numSamples, numIterations) {
+    const auto result = join(inline_task_chain<chainDepth>());
+    assert(result == chainDepth);
+    celero::DoNotOptimizeAway(result);
 }
\ No newline at end of file
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "cancellation.hpp"
+#include "promise.hpp"
+
+#include <cassert>
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+
+
+namespace asyncpp {
+
+
+template <class T, class Alloc>
+class async_generator;
+
+
+namespace impl_async_generator {
+
+    template <class T>
+    using reference_type = std::conditional_t<std::is_reference_v<T>, T, T&>;
+
+    template <class T>
+    using pointer_type = std::add_pointer_t<reference_type<T>>;
+
+
+    // Points to the yielded object, which is valid until the generator is awaited again.
+    template <class T>
+    class [[nodiscard]] item {
+    public:
+        explicit item(pointer_type<T> value) noexcept : m_value(value) {}
+
+        explicit operator bool() const noexcept {
+            return !!m_value;
+        }
+
+        reference_type<T> operator*() const noexcept {
+            assert(m_value);
+            return static_cast<reference_type<T>>(*m_value);
+        }
+
+        pointer_type<T> operator->() const noexcept {
+            assert(m_value);
+            return m_value;
+        }
+
+    private:
+        pointer_type<T> m_value;
+    };
+
+
+    // The generator runs on the thread of its consumer between two yields, and control is passed
+    // back and forth by symmetric transfer. When the generator is resumed by something it awaited,
+    // it's no longer on the consumer's stack, so it resumes the consumer through its promise.
+    template <class T>
+    struct promise_base : resumable_promise, stoppable_promise {
+        pointer_type<T> m_value = nullptr;
+        std::exception_ptr m_exception;
+        resumable_promise* m_consumer = nullptr;
+        std::coroutine_handle<> m_consumer_handle;
+        std::coroutine_handle<> m_handle;
+        bool m_detached = false;
+
+        void resume() final {
+            m_detached = true;
+            m_handle.resume();
+        }
+
+        std::coroutine_handle<> transfer_to_consumer() noexcept {
+            if (m_detached) {
+                m_detached = false;
+                // The consumer may resume the generator before this returns.
+                m_consumer->resume();
+                return std::noop_coroutine();
+            }
+            return m_consumer_handle;
+        }
+    };
+
+
+    template <class T>
+    struct yield_awaitable {
+        constexpr bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <std::derived_from<promise_base<T>> Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept {
+            return handle.promise().transfer_to_consumer();
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+
+    // Lvalues yielded from a generator of values are copied, as for `generator`.
+    template <class T>
+    struct copy_awaitable {
+        T m_value;
+
+        constexpr bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <std::derived_from<promise_base<T>> Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            auto& promise = handle.promise();
+            promise.m_value = std::addressof(m_value);
+            return promise.transfer_to_consumer();
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+
+    template <class T, class Alloc>
+    struct promise : promise_base<T>, allocator_aware_promise<Alloc> {
+        auto get_return_object() noexcept {
+            this->m_handle = std::coroutine_handle<promise>::from_promise(*this);
+            return async_generator<T, Alloc>(this);
+        }
+
+        constexpr std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+
+        yield_awaitable<T> final_suspend() const noexcept {
+            return {};
+        }
+
+        // Temporaries live until the coroutine is resumed, so they are not copied.
+        yield_awaitable<T> yield_value(std::conditional_t<std::is_reference_v<T>, T, T&&> value) noexcept {
+            this->m_value = std::addressof(value);
+            return {};
+        }
+
+        copy_awaitable<T> yield_value(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>)
+            requires(!std::is_reference_v<T>)
+        {
+            return { value };
+        }
+
+        void unhandled_exception() noexcept {
+            this->m_exception = std::current_exception();
+        }
+
+        void return_void() noexcept {}
+    };
+
+
+    template <class T, class Alloc>
+    struct awaitable {
+        promise<T, Alloc>* m_promise;
+
+        bool await_ready() const noexcept {
+            return m_promise->m_handle.done();
+        }
+
+        // The generator inherits the stop token of its consumer, unless it has its own.
+        template <std::convertible_to<const resumable_promise&> Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> enclosing) noexcept {
+            m_promise->m_consumer = &enclosing.promise();
+            m_promise->m_consumer_handle = enclosing;
+            m_promise->m_value = nullptr;
+            if (!m_promise->m_stop_token.stop_possible()) {
+                m_promise->m_stop_token = impl_cancellation::get_stop_token(enclosing.promise());
+            }
+            return m_promise->m_handle;
+        }
+
+        item<T> await_resume() const {
+            if (m_promise->m_exception) {
+                std::rethrow_exception(std::exchange(m_promise->m_exception, nullptr));
+            }
+            return item<T>(m_promise->m_handle.done() ? nullptr : m_promise->m_value);
+        }
+    };
+
+} // namespace impl_async_generator
+
+
+// A generator whose body may `co_await`. The consumer awaits the generator for each item:
+// `while (const auto item = co_await g) { use(*item); }`. Unlike streams, async generators
+// are not scheduled and do not allocate per item: the consumer runs the generator until it
+// yields, so they cost about the same as a synchronous generator when they don't suspend.
+template <class T, class Alloc = void>
+class [[nodiscard]] async_generator {
+public:
+    using promise_type = impl_async_generator::promise<T, Alloc>;
+
+    async_generator(promise_type* promise) : m_promise(promise) {}
+    async_generator() = default;
+    async_generator(async_generator&& rhs) noexcept : m_promise(std::exchange(rhs.m_promise, nullptr)) {}
+    async_generator& operator=(async_generator&& rhs) noexcept {
+        release();
+        m_promise = std::exchange(rhs.m_promise, nullptr);
+        return *this;
+    }
+    async_generator(const async_generator&) = delete;
+    async_generator& operator=(const async_generator&) = delete;
+    ~async_generator() {
+        release();
+    }
+
+    bool valid() const {
+        return !!m_promise;
+    }
+
+    // Must be called before the generator is first awaited.
+    void set_stop_token(std::stop_token token) {
+        assert(valid());
+        m_promise->m_stop_token = std::move(token);
+    }
+
+    auto operator co_await() noexcept {
+        assert(valid());
+        return impl_async_generator::awaitable<T, Alloc>{ m_promise };
+    }
+
+private:
+    void release() {
+        if (m_promise) {
+            std::coroutine_handle<promise_type>::from_promise(*m_promise).destroy();
+        }
+    }
+
+private:
+    promise_type* m_promise = nullptr;
+};
+
+} // namespace asyncpp
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "container/atomic_collection.hpp"
+#include "promise.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+
+namespace asyncpp {
+
+
+namespace impl_barrier {
+
+    struct empty_completion {
+        constexpr void operator()() const noexcept {}
+    };
+
+} // namespace impl_barrier
+
+
+// A reusable barrier for a fixed set of coroutines, similar to `std::barrier`. The phase is
+// completed when all of them have arrived: then the completion function is called by the last
+// one to arrive, and all the others are resumed together.
+//
+// Arriving is a single atomic operation. The waiting coroutines of consecutive phases go to
+// two alternating collections, so that the collection of a phase can be closed without
+// affecting coroutines that are already arriving for the next phase.
+template <std::invocable CompletionFunction = impl_barrier::empty_completion>
+class barrier {
+    struct awaitable {
+        barrier* m_owner = nullptr;
+        size_t m_phase = 0;
+        bool m_completed = false;
+        resumable_promise* m_enclosing = nullptr;
+        awaitable* m_next = nullptr;
+
+        bool await_ready() const noexcept {
+            return m_completed;
+        }
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> promise) noexcept {
+            assert(m_owner);
+            m_enclosing = &promise.promise();
+            auto& awaiters = m_owner->m_awaiters[m_phase];
+            const auto status = awaiters.push(this);
+            return !awaiters.closed(status);
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+public:
+    explicit barrier(ptrdiff_t expected, CompletionFunction completion = CompletionFunction()) noexcept(std::is_nothrow_move_constructible_v<CompletionFunction>)
+        : m_state(size_t(expected) * counter_unit), m_expected(expected), m_completion(std::move(completion)) {
+        assert(expected > 0);
+    }
+    barrier(barrier&&) = delete;
+    barrier& operator=(barrier&&) = delete;
+    ~barrier() {
+        assert(m_awaiters[0].empty() && m_awaiters[1].empty());
+    }
+
+    // Arrives immediately, the returned awaitable waits for the others.
+    awaitable arrive_and_wait() {
+        const auto [phase, completed] = arrive();
+        return { this, phase, completed };
+    }
+
+    // Arrives for the current phase, and leaves the barrier for the next phases.
+    void arrive_and_drop() {
+        m_expected.fetch_sub(1, std::memory_order_relaxed);
+        arrive();
+    }
+
+private:
+    std::pair<size_t, bool> arrive() {
+        const auto previous = m_state.fetch_sub(counter_unit, std::memory_order_acq_rel);
+        const size_t phase = previous & phase_bit;
+        assert(previous / counter_unit > 0);
+        if (previous / counter_unit != 1) {
+            return { phase, false };
+        }
+        complete(phase);
+        return { phase, true };
+    }
+
+    void complete(size_t phase) {
+        m_completion();
+        // Nobody can wait for the next phase before it starts, so its collection is no longer used.
+        m_awaiters[phase ^ phase_bit].reopen();
+        const auto expected = size_t(m_expected.load(std::memory_order_relaxed));
+        m_state.store(expected * counter_unit | (phase ^ phase_bit), std::memory_order_release);
+        resume_all(m_awaiters[phase].close());
+    }
+
+private:
+    // The number of coroutines yet to arrive is stored shifted left by one, the lowest bit is the
+    // parity of the current phase.
+    static constexpr size_t phase_bit = 1;
+    static constexpr size_t counter_unit = 2;
+
+    std::atomic<size_t> m_state;
+    std::atomic<ptrdiff_t> m_expected;
+    atomic_collection<awaitable, &awaitable::m_next> m_awaiters[2];
+    CompletionFunction m_completion;
+};
+
+} // namespace asyncpp
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "promise.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <coroutine>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+
+
+namespace asyncpp {
+
+
+class operation_cancelled : public std::runtime_error {
+public:
+    operation_cancelled() : std::runtime_error("operation cancelled") {}
+};
+
+
+namespace impl_cancellation {
+
+    template <class Promise>
+    std::stop_token get_stop_token(const Promise& promise) noexcept {
+        if constexpr (std::convertible_to<const Promise&, const stoppable_promise&>) {
+            return static_cast<const stoppable_promise&>(promise).m_stop_token;
+        }
+        else {
+            return {};
+        }
+    }
+
+
+    // Resumes a suspended awaitable early when stop is requested on the awaiting coroutine.
+    //
+    // The primitive resumes the listener instead of the coroutine, so that the coroutine
+    // is not resumed before the awaitable has finished suspending. When stop is requested,
+    // the awaitable must take itself off the primitive's waiting list via `try_cancel`, and
+    // only if that succeeds is the coroutine resumed as cancelled.
+    template <class Awaitable>
+    class stop_listener : public resumable_promise {
+        struct callback {
+            stop_listener* m_owner;
+            void operator()() const noexcept {
+                m_owner->cancel();
+            }
+        };
+
+    public:
+        stop_listener() = default;
+        // Awaitables may be copied before they are suspended, a copy does not listen.
+        stop_listener(const stop_listener&) noexcept : resumable_promise() {}
+        stop_listener& operator=(const stop_listener&) noexcept { return *this; }
+
+        // Returns the promise the primitive must resume once the awaitable completes.
+        resumable_promise* intercept(resumable_promise& enclosing) noexcept {
+            m_enclosing = &enclosing;
+            return this;
+        }
+
+        // Call after the awaitable has been added to the primitive's waiting list.
+        // Returns whether the coroutine should stay suspended.
+        bool listen(Awaitable* awaitable, std::stop_token token) {
+            assert(token.stop_possible());
+            m_awaitable = awaitable;
+            m_callback.emplace(std::move(token), callback{ this });
+            return 1 != m_pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        bool cancelled() const noexcept {
+            return m_cancelled;
+        }
+
+        void resume() override {
+            complete();
+        }
+
+    private:
+        void cancel() noexcept {
+            assert(m_awaitable);
+            if (m_awaitable->try_cancel()) {
+                m_cancelled = true;
+                complete();
+            }
+        }
+
+        void complete() {
+            // One count for the completion, one for the awaitable until it has suspended.
+            if (1 == m_pending.fetch_sub(1, std::memory_order_acq_rel)) {
+                assert(m_enclosing);
+                m_enclosing->resume();
+            }
+        }
+
+    private:
+        std::optional<std::stop_callback<callback>> m_callback;
+        std::atomic_int m_pending = 2;
+        bool m_cancelled = false;
+        Awaitable* m_awaitable = nullptr;
+        resumable_promise* m_enclosing = nullptr;
+    };
+
+
+    struct stop_token_awaitable {
+        std::stop_token m_token;
+
+        constexpr bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <class Promise>
+        bool await_suspend(std::coroutine_handle<Promise> enclosing) noexcept {
+            m_token = get_stop_token(enclosing.promise());
+            return false;
+        }
+
+        std::stop_token await_resume() noexcept {
+            return std::move(m_token);
+        }
+    };
+
+} // namespace impl_cancellation
+
+
+// Retrieves the stop token of the current coroutine: `co_await get_stop_token()`.
+inline auto get_stop_token() noexcept {
+    return impl_cancellation::stop_token_awaitable{};
+}
+
+} // namespace asyncpp
\ No newline at end of file
@@ -0,0 +1,511 @@
+#pragma once
+
+#include "cancellation.hpp"
+#include "container/atomic_deque.hpp"
+#include "promise.hpp"
+#include "threading/cache.hpp"
+#include "threading/spinlock.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace asyncpp {
+
+namespace impl_channel {
+
+    // A bounded multi-producer multi-consumer queue. Each cell has a sequence number that
+    // tells whether the cell is ready for the push (2 * position) or for the pop (2 * position + 1)
+    // at a given position, so producers and consumers only contend on claiming positions,
+    // and need no lock.
+    template <class T>
+    class ring_buffer {
+        struct cell {
+            std::atomic_size_t m_sequence;
+            alignas(T) std::byte m_storage[sizeof(T)];
+        };
+
+    public:
+        explicit ring_buffer(size_t capacity)
+            : m_capacity(capacity), m_cells(std::make_unique<cell[]>(capacity)) {
+            assert(capacity > 0);
+            for (size_t index = 0; index < capacity; ++index) {
+                m_cells[index].m_sequence.store(2 * index, std::memory_order_relaxed);
+            }
+        }
+
+        ring_buffer(const ring_buffer&) = delete;
+        ring_buffer& operator=(const ring_buffer&) = delete;
+
+        ~ring_buffer() {
+            while (try_pop()) {
+            }
+        }
+
+        // The value is only moved from if the push succeeds.
+        bool try_push(T&& value) noexcept {
+            auto position = m_push_position.load(std::memory_order_relaxed);
+            while (true) {
+                auto& cell = m_cells[position % m_capacity];
+                const auto sequence = cell.m_sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<ptrdiff_t>(sequence - 2 * position);
+                if (difference == 0) {
+                    if (m_push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        new (cell.m_storage) T(std::move(value));
+                        cell.m_sequence.store(2 * position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0) {
+                    return false;
+                }
+                else {
+                    position = m_push_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::optional<T> try_pop() noexcept {
+            auto position = m_pop_position.load(std::memory_order_relaxed);
+            while (true) {
+                auto& cell = m_cells[position % m_capacity];
+                const auto sequence = cell.m_sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<ptrdiff_t>(sequence - (2 * position + 1));
+                if (difference == 0) {
+                    if (m_pop_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        const auto item = std::launder(reinterpret_cast<T*>(cell.m_storage));
+                        std::optional<T> value(std::move(*item));
+                        item->~T();
+                        cell.m_sequence.store(2 * (position + m_capacity), std::memory_order_release);
+                        return value;
+                    }
+                }
+                else if (difference < 0) {
+                    return std::nullopt;
+                }
+                else {
+                    position = m_pop_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        size_t capacity() const noexcept {
+            return m_capacity;
+        }
+
+    private:
+        const size_t m_capacity;
+        std::unique_ptr<cell[]> m_cells;
+        alignas(avoid_false_sharing) std::atomic_size_t m_push_position = 0;
+        alignas(avoid_false_sharing) std::atomic_size_t m_pop_position = 0;
+    };
+
+} // namespace impl_channel
+
+
+// A multi-producer multi-consumer queue of values for passing data between coroutines.
+//
+// Values are passed through a lock-free ring buffer. Only when a sender finds the buffer
+// full, or a receiver finds it empty, does it take the channel's lock to wait. Bounded
+// channels suspend the senders when the buffer is full, unbounded channels never do.
+template <class T>
+class channel {
+    static_assert(std::is_nothrow_move_constructible_v<T>, "values are moved into the buffer after their cell is claimed");
+
+    static constexpr size_t unbounded_buffer_size = 256;
+
+    struct send_awaitable {
+        channel* m_owner = nullptr;
+        std::optional<T> m_value;
+        resumable_promise* m_enclosing = nullptr;
+        send_awaitable* m_prev = nullptr;
+        send_awaitable* m_next = nullptr;
+        bool m_sent = false;
+        bool m_queued = false;
+        impl_cancellation::stop_listener<send_awaitable> m_listener = {};
+
+        bool await_ready() noexcept {
+            assert(m_owner);
+            return m_owner->try_send_ready(*this);
+        }
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> promise) noexcept {
+            assert(m_owner);
+            auto token = impl_cancellation::get_stop_token(promise.promise());
+            if (!token.stop_possible()) {
+                m_enclosing = &promise.promise();
+                return m_owner->enqueue(this);
+            }
+            m_enclosing = m_listener.intercept(promise.promise());
+            return m_owner->enqueue(this) && m_listener.listen(this, std::move(token));
+        }
+
+        bool await_resume() const {
+            if (m_listener.cancelled()) {
+                throw operation_cancelled();
+            }
+            return m_sent;
+        }
+
+        bool try_cancel() noexcept {
+            assert(m_owner);
+            return m_owner->remove(this);
+        }
+    };
+
+    struct receive_awaitable {
+        channel* m_owner = nullptr;
+        std::optional<T> m_value;
+        resumable_promise* m_enclosing = nullptr;
+        receive_awaitable* m_prev = nullptr;
+        receive_awaitable* m_next = nullptr;
+        bool m_queued = false;
+        impl_cancellation::stop_listener<receive_awaitable> m_listener = {};
+
+        bool await_ready() noexcept {
+            assert(m_owner);
+            m_value = m_owner->try_receive();
+            return m_value.has_value();
+        }
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> promise) noexcept {
+            assert(m_owner);
+            auto token = impl_cancellation::get_stop_token(promise.promise());
+            if (!token.stop_possible()) {
+                m_enclosing = &promise.promise();
+                return m_owner->enqueue(this);
+            }
+            m_enclosing = m_listener.intercept(promise.promise());
+            return m_owner->enqueue(this) && m_listener.listen(this, std::move(token));
+        }
+
+        std::optional<T> await_resume() {
+            if (m_listener.cancelled()) {
+                throw operation_cancelled();
+            }
+            if (!m_value) {
+                // Closed, but a value may have been sent concurrently with closing.
+                m_value = m_owner->try_receive();
+            }
+            return std::move(m_value);
+        }
+
+        bool try_cancel() noexcept {
+            assert(m_owner);
+            return m_owner->remove(this);
+        }
+    };
+
+    struct receive_many_awaitable : receive_awaitable {
+        size_t m_max = 0;
+
+        std::vector<T> await_resume() {
+            auto first = receive_awaitable::await_resume();
+            std::vector<T> values;
+            if (first) {
+                values.push_back(std::move(*first));
+                while (values.size() < m_max) {
+                    auto value = this->m_owner->try_receive();
+                    if (!value) {
+                        break;
+                    }
+                    values.push_back(std::move(*value));
+                }
+            }
+            return values;
+        }
+    };
+
+    using senders = deque<send_awaitable, &send_awaitable::m_prev, &send_awaitable::m_next>;
+    using receivers = deque<receive_awaitable, &receive_awaitable::m_prev, &receive_awaitable::m_next>;
+
+public:
+    static constexpr size_t unbounded = std::numeric_limits<size_t>::max();
+
+    explicit channel(size_t capacity = unbounded)
+        : m_buffer(capacity == unbounded ? unbounded_buffer_size : capacity), m_bounded(capacity != unbounded) {}
+
+    channel(const channel&) = delete;
+    channel& operator=(const channel&) = delete;
+
+    ~channel() {
+        assert(m_senders.empty() && m_receivers.empty());
+    }
+
+    // Returns whether the value was sent, and fails if the channel is closed.
+    // Sending to a bounded channel suspends until there is space in the buffer.
+    send_awaitable send(T value) noexcept {
+        return { this, std::move(value) };
+    }
+
+    // Returns no value if the channel is closed and all values have been received.
+    receive_awaitable receive() noexcept {
+        return { this };
+    }
+
+    // Receives at least one and at most `max` values, or none if the channel is closed and all
+    // values have been received. Only waits for the first value, the rest are taken if available.
+    receive_many_awaitable receive_many(size_t max) noexcept {
+        assert(max > 0);
+        return { { this }, max };
+    }
+
+    bool try_send(T value) {
+        if (m_closed.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (m_num_waiting_senders.load(std::memory_order_relaxed) == 0 && m_buffer.try_push(std::move(value))) {
+            notify_receivers();
+            return true;
+        }
+        if (!m_bounded) {
+            return overflow(std::move(value));
+        }
+        return false;
+    }
+
+    std::optional<T> try_receive() noexcept {
+        auto value = m_buffer.try_pop();
+        if (value) {
+            notify_senders();
+        }
+        return value;
+    }
+
+    // Fails the pending and future sends. Values already sent can still be received.
+    void close() noexcept {
+        senders resumed_senders;
+        receivers resumed_receivers;
+        {
+            std::lock_guard lk(m_spinlock);
+            m_closed.store(true, std::memory_order_release);
+            settle(resumed_senders, resumed_receivers);
+            while (const auto sender = m_senders.pop_front()) {
+                sender->m_queued = false;
+                m_num_waiting_senders.fetch_sub(1, std::memory_order_relaxed);
+                resumed_senders.push_back(sender);
+            }
+            if (m_overflow.empty()) {
+                while (const auto receiver = m_receivers.pop_front()) {
+                    receiver->m_queued = false;
+                    m_num_waiting_receivers.fetch_sub(1, std::memory_order_relaxed);
+                    resumed_receivers.push_back(receiver);
+                }
+            }
+        }
+        resume(resumed_senders, resumed_receivers);
+    }
+
+    bool closed() const noexcept {
+        return m_closed.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const noexcept {
+        return m_bounded ? m_buffer.capacity() : unbounded;
+    }
+
+private:
+    bool try_send_ready(send_awaitable& awaitable) {
+        assert(awaitable.m_value);
+        if (m_closed.load(std::memory_order_acquire)) {
+            return true;
+        }
+        if (m_num_waiting_senders.load(std::memory_order_relaxed) == 0 && m_buffer.try_push(std::move(*awaitable.m_value))) {
+            awaitable.m_sent = true;
+            notify_receivers();
+            return true;
+        }
+        if (!m_bounded) {
+            awaitable.m_sent = overflow(std::move(*awaitable.m_value));
+            return true;
+        }
+        return false;
+    }
+
+    bool overflow(T&& value) {
+        senders resumed_senders;
+        receivers resumed_receivers;
+        {
+            std::lock_guard lk(m_spinlock);
+            if (m_closed.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            m_overflow.push_back(std::move(value));
+            m_num_waiting_senders.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            settle(resumed_senders, resumed_receivers);
+        }
+        resume(resumed_senders, resumed_receivers);
+        return true;
+    }
+
+    // Returns whether the sender has to wait.
+    bool enqueue(send_awaitable* sender) noexcept {
+        senders resumed_senders;
+        receivers resumed_receivers;
+        bool waiting = true;
+        {
+            std::lock_guard lk(m_spinlock);
+            if (m_closed.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            sender->m_queued = true;
+            m_senders.push_back(sender);
+            m_num_waiting_senders.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            settle(resumed_senders, resumed_receivers);
+            if (sender->m_sent) {
+                resumed_senders.erase(sender);
+                waiting = false;
+            }
+        }
+        resume(resumed_senders, resumed_receivers);
+        return waiting;
+    }
+
+    // Returns whether the receiver has to wait.
+    bool enqueue(receive_awaitable* receiver) noexcept {
+        senders resumed_senders;
+        receivers resumed_receivers;
+        bool waiting = true;
+        {
+            std::lock_guard lk(m_spinlock);
+            receiver->m_queued = true;
+            m_receivers.push_back(receiver);
+            m_num_waiting_receivers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            settle(resumed_senders, resumed_receivers);
+            if (receiver->m_value) {
+                resumed_receivers.erase(receiver);
+                waiting = false;
+            }
+            else if (m_closed.load(std::memory_order_relaxed) && m_overflow.empty()) {
+                m_receivers.erase(receiver);
+                receiver->m_queued = false;
+                m_num_waiting_receivers.fetch_sub(1, std::memory_order_relaxed);
+                waiting = false;
+            }
+        }
+        resume(resumed_senders, resumed_receivers);
+        return waiting;
+    }
+
+    bool remove(send_awaitable* sender) noexcept {
+        std::lock_guard lk(m_spinlock);
+        if (sender->m_queued) {
+            m_senders.erase(sender);
+            sender->m_queued = false;
+            m_num_waiting_senders.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    bool remove(receive_awaitable* receiver) noexcept {
+        std::lock_guard lk(m_spinlock);
+        if (receiver->m_queued) {
+            m_receivers.erase(receiver);
+            receiver->m_queued = false;
+            m_num_waiting_receivers.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    // A value was pushed to the buffer. The fence pairs with the one in `enqueue`: either
+    // the waiting receiver sees the value, or this sees the waiting receiver.
+    void notify_receivers() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_num_waiting_receivers.load(std::memory_order_relaxed) != 0) {
+            settle();
+        }
+    }
+
+    // Space was freed in the buffer.
+    void notify_senders() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_num_waiting_senders.load(std::memory_order_relaxed) != 0) {
+            settle();
+        }
+    }
+
+    void settle() noexcept {
+        senders resumed_senders;
+        receivers resumed_receivers;
+        {
+            std::lock_guard lk(m_spinlock);
+            settle(resumed_senders, resumed_receivers);
+        }
+        resume(resumed_senders, resumed_receivers);
+    }
+
+    // Moves values from the buffer to the waiting receivers, and from the waiting senders to the
+    // buffer, until neither is possible. Must be called with the lock held.
+    void settle(senders& resumed_senders, receivers& resumed_receivers) noexcept {
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            while (!m_receivers.empty()) {
+                auto value = m_buffer.try_pop();
+                if (!value) {
+                    break;
+                }
+                const auto receiver = m_receivers.pop_front();
+                receiver->m_queued = false;
+                receiver->m_value = std::move(value);
+                m_num_waiting_receivers.fetch_sub(1, std::memory_order_relaxed);
+                resumed_receivers.push_back(receiver);
+                progress = true;
+            }
+            while (!m_overflow.empty() && m_buffer.try_push(std::move(m_overflow.front()))) {
+                m_overflow.pop_front();
+                m_num_waiting_senders.fetch_sub(1, std::memory_order_relaxed);
+                progress = true;
+            }
+            while (m_overflow.empty() && !m_senders.empty() && m_buffer.try_push(std::move(*m_senders.front()->m_value))) {
+                const auto sender = m_senders.pop_front();
+                sender->m_queued = false;
+                sender->m_sent = true;
+                m_num_waiting_senders.fetch_sub(1, std::memory_order_relaxed);
+                resumed_senders.push_back(sender);
+                progress = true;
+            }
+        }
+    }
+
+    static void resume(senders& resumed_senders, receivers& resumed_receivers) {
+        while (const auto sender = resumed_senders.pop_front()) {
+            assert(sender->m_enclosing);
+            sender->m_enclosing->resume();
+        }
+        while (const auto receiver = resumed_receivers.pop_front()) {
+            assert(receiver->m_enclosing);
+            receiver->m_enclosing->resume();
+        }
+    }
+
+private:
+    impl_channel::ring_buffer<T> m_buffer;
+    const bool m_bounded;
+    alignas(avoid_false_sharing) std::atomic_size_t m_num_waiting_senders = 0;
+    alignas(avoid_false_sharing) std::atomic_size_t m_num_waiting_receivers = 0;
+    alignas(avoid_false_sharing) std::atomic_bool m_closed = false;
+    spinlock m_spinlock;
+    senders m_senders;
+    receivers m_receivers;
+    std::deque<T> m_overflow;
+};
+
+} // namespace asyncpp
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "cancellation.hpp"
+#include "container/atomic_deque.hpp"
+#include "lock.hpp"
+#include "mutex.hpp"
+#include "promise.hpp"
+#include "threading/spinlock.hpp"
+
+#include <cassert>
+#include <concepts>
+#include <coroutine>
+#include <optional>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+
+
+namespace asyncpp {
+
+// Coroutines wait on the condition variable while holding an `asyncpp::mutex`, which is
+// unlocked while they wait, and locked again when they are resumed, same as `std::condition_variable`.
+//
+// Notified coroutines are not resumed to compete for the mutex: they are moved directly to
+// the waiting queue of the mutex, and each of them is resumed only when it has acquired the mutex.
+class condition_variable {
+    struct no_predicate {};
+
+    struct basic_awaitable : resumable_promise {
+        struct callback {
+            basic_awaitable* m_owner;
+            void operator()() const noexcept {
+                m_owner->cancel();
+            }
+        };
+
+        condition_variable* m_owner = nullptr;
+        mutex* m_mtx = nullptr;
+        resumable_promise* m_enclosing = nullptr;
+        basic_awaitable* m_next = nullptr;
+        basic_awaitable* m_prev = nullptr;
+        bool m_queued = false;
+        bool m_cancelled = false;
+        mutex::awaitable m_relock = {};
+        std::stop_token m_token;
+        std::optional<std::stop_callback<callback>> m_callback;
+
+        basic_awaitable(condition_variable* owner, mutex* mtx) noexcept : m_owner(owner), m_mtx(mtx) {}
+
+        // Whether the wait is over after the mutex has been locked again. Without a predicate,
+        // it's over unless it was cancelled.
+        virtual bool done() = 0;
+
+        // Called when the mutex is locked again.
+        void resume() final;
+        void wait(resumable_promise& enclosing, std::stop_token token);
+        void relock();
+        void cancel() noexcept;
+        void await_resume() const;
+    };
+
+    template <class Pred>
+    struct awaitable : basic_awaitable {
+        Pred m_pred;
+
+        awaitable(condition_variable* owner, mutex* mtx, Pred pred) : basic_awaitable(owner, mtx), m_pred(std::move(pred)) {}
+
+        bool await_ready() {
+            if constexpr (std::is_same_v<Pred, no_predicate>) {
+                return false;
+            }
+            else {
+                return m_pred();
+            }
+        }
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        void await_suspend(std::coroutine_handle<Promise> enclosing) {
+            wait(enclosing.promise(), impl_cancellation::get_stop_token(enclosing.promise()));
+        }
+
+        bool done() override {
+            if constexpr (std::is_same_v<Pred, no_predicate>) {
+                return !m_cancelled;
+            }
+            else {
+                return m_pred();
+            }
+        }
+    };
+
+    using queue_type = deque<basic_awaitable, &basic_awaitable::m_prev, &basic_awaitable::m_next>;
+
+    bool add_awaiting(basic_awaitable* waiting);
+    bool remove_awaiting(basic_awaitable* waiting) noexcept;
+
+public:
+    condition_variable() = default;
+    condition_variable(const condition_variable&) = delete;
+    condition_variable(condition_variable&&) = delete;
+    condition_variable& operator=(const condition_variable&) = delete;
+    condition_variable& operator=(condition_variable&&) = delete;
+    ~condition_variable();
+
+    // The lock must own the mutex, and it owns the mutex again when the wait is over, even
+    // if the wait was cancelled.
+    awaitable<no_predicate> wait(unique_lock<mutex>& lk) noexcept;
+
+    // Waits until the predicate, which is evaluated with the mutex locked, is true.
+    template <std::predicate Pred>
+    awaitable<std::decay_t<Pred>> wait(unique_lock<mutex>& lk, Pred&& pred);
+
+    void notify_one();
+    void notify_all();
+
+    void _debug_clear() noexcept;
+
+private:
+    queue_type m_queue;
+    spinlock m_spinlock;
+};
+
+
+template <std::predicate Pred>
+condition_variable::awaitable<std::decay_t<Pred>> condition_variable::wait(unique_lock<mutex>& lk, Pred&& pred) {
+    assert(lk.owns_lock());
+    return { this, &lk.mutex(), std::forward<Pred>(pred) };
+}
+
+} // namespace asyncpp
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "../testing/suspension_point.hpp"
 
 #include <atomic>
+#include <cassert>
 #include <limits>
 
 
@@ -29,6 +30,12 @@ public:
         return INTERLEAVED(m_first.exchange(CLOSED));
     }
 
+    // Makes a closed collection empty, does nothing if it's not closed.
+    bool reopen() noexcept {
+        Element* expected = CLOSED;
+        return INTERLEAVED(m_first.compare_exchange_strong(expected, nullptr));
+    }
+
     bool empty() const noexcept {
         const auto item = m_first.load(std::memory_order_relaxed);
         return item == nullptr || closed(item);
@@ -51,4 +58,17 @@ private:
     static inline Element* const CLOSED = reinterpret_cast<Element*>(std::numeric_limits<size_t>::max());
 };
 
+
+// Resumes the coroutines of the awaitables in a list detached from an `atomic_collection`.
+template <class Awaitable>
+void resume_all(Awaitable* first) {
+    while (first != nullptr) {
+        // The awaitable is gone once its coroutine is resumed.
+        const auto next = first->m_next;
+        assert(first->m_enclosing);
+        first->m_enclosing->resume();
+        first = next;
+    }
+}
+
 } // namespace asyncpp
\ No newline at end of file
@@ -65,6 +65,15 @@ public:
         return nullptr;
     }
 
+    void erase(Element* element) noexcept {
+        const auto before = element->*prev;
+        const auto after = element->*next;
+        (before ? before->*next : m_front) = after;
+        (after ? after->*prev : m_back) = before;
+        element->*prev = nullptr;
+        element->*next = nullptr;
+    }
+
     Element* front() const noexcept {
         return m_front;
     }
@@ -106,6 +115,11 @@ public:
         return m_container.pop_back();
     }
 
+    void erase(Element* element) noexcept {
+        std::lock_guard lk(m_mutex);
+        m_container.erase(element);
+    }
+
     Element* front() const noexcept {
         std::lock_guard lk(m_mutex);
         return m_container.front();
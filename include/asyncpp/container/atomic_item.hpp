@@ -19,6 +19,11 @@ public:
         return expected;
     }
 
+    bool remove(Element* element) noexcept {
+        Element* expected = element;
+        return INTERLEAVED(m_item.compare_exchange_strong(expected, nullptr));
+    }
+
     Element* close() noexcept {
         return INTERLEAVED(m_item.exchange(CLOSED));
     }
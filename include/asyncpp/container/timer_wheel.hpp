@@ -0,0 +1,141 @@
+#pragma once
+
+#include "atomic_deque.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+
+namespace asyncpp {
+
+// A hierarchical timing wheel of intrusive timers.
+//
+// Timers are hashed into slots by their deadline tick, so insertion and removal
+// are O(1). Each level has 64 slots and covers 64 times the range of the level
+// below it. Timers far in the future sit on the coarser levels, and cascade down
+// to the finer levels as the wheel turns. Timers beyond the last level are kept
+// in an overflow slot that is re-examined every full turn.
+template <class Element, Element* Element::*prev, Element* Element::*next, uint64_t Element::*tick, size_t Element::*slot>
+class timer_wheel {
+    static constexpr size_t slot_bits = 6;
+    static constexpr size_t num_slots = size_t(1) << slot_bits;
+    static constexpr size_t slot_mask = num_slots - 1;
+    static constexpr size_t num_levels = 4;
+    static constexpr size_t overflow_slot = num_levels * num_slots;
+
+public:
+    using list = deque<Element, prev, next>;
+
+    static constexpr size_t no_slot = std::numeric_limits<size_t>::max();
+    static constexpr uint64_t never = std::numeric_limits<uint64_t>::max();
+
+    // Timers that are already due are moved to the current tick. Returns the tick the timer fires at.
+    uint64_t insert(Element* element) noexcept {
+        const auto due = std::max(element->*tick, m_current);
+        const auto delta = due - m_current;
+        size_t index = overflow_slot;
+        for (size_t level = 0; level < num_levels; ++level) {
+            if (delta < (uint64_t(1) << (slot_bits * (level + 1)))) {
+                index = level * num_slots + ((due >> (slot_bits * level)) & slot_mask);
+                break;
+            }
+        }
+        element->*slot = index;
+        m_slots[index].push_back(element);
+        ++m_size;
+        return due;
+    }
+
+    bool erase(Element* element) noexcept {
+        if (element->*slot == no_slot) {
+            return false;
+        }
+        m_slots[element->*slot].erase(element);
+        element->*slot = no_slot;
+        --m_size;
+        return true;
+    }
+
+    // Turns the wheel up to and including tick `now`, and appends the expired timers to `expired`.
+    void advance(uint64_t now, list& expired) noexcept {
+        while (m_size != 0 && m_current <= now) {
+            cascade();
+            auto& current = m_slots[m_current & slot_mask];
+            while (const auto element = current.pop_front()) {
+                element->*slot = no_slot;
+                --m_size;
+                expired.push_back(element);
+            }
+            ++m_current;
+        }
+        // An empty wheel can skip ahead freely.
+        m_current = std::max(m_current, now + 1);
+    }
+
+    // Removes all timers, and appends them to `removed`.
+    void clear(list& removed) noexcept {
+        for (auto& elements : m_slots) {
+            while (const auto element = elements.pop_front()) {
+                element->*slot = no_slot;
+                removed.push_back(element);
+            }
+        }
+        m_size = 0;
+    }
+
+    // A lower bound on the tick of the earliest timer. The wheel must be advanced at that tick
+    // even if no timers expire, as timers may have to cascade down from the coarser levels.
+    uint64_t next_tick() const noexcept {
+        if (m_size == 0) {
+            return never;
+        }
+        if ((m_current & slot_mask) == 0) {
+            return m_current;
+        }
+        const auto boundary = (m_current | slot_mask) + 1;
+        for (auto current = m_current; current < boundary; ++current) {
+            if (!m_slots[current & slot_mask].empty()) {
+                return current;
+            }
+        }
+        return boundary;
+    }
+
+    uint64_t current() const noexcept {
+        return m_current;
+    }
+
+    size_t size() const noexcept {
+        return m_size;
+    }
+
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+private:
+    void cascade() noexcept {
+        for (size_t level = 1; level <= num_levels; ++level) {
+            // Only cascade a level when the level below it has wrapped around.
+            if (((m_current >> (slot_bits * (level - 1))) & slot_mask) != 0) {
+                break;
+            }
+            const auto index = level < num_levels ? level * num_slots + ((m_current >> (slot_bits * level)) & slot_mask) : overflow_slot;
+            auto elements = std::exchange(m_slots[index], list{});
+            while (const auto element = elements.pop_front()) {
+                --m_size;
+                insert(element);
+            }
+        }
+    }
+
+private:
+    std::array<list, num_levels * num_slots + 1> m_slots;
+    uint64_t m_current = 0;
+    size_t m_size = 0;
+};
+
+} // namespace asyncpp
\ No newline at end of file
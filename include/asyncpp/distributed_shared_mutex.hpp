@@ -0,0 +1,115 @@
+#pragma once
+
+#include "container/atomic_deque.hpp"
+#include "lock.hpp"
+#include "promise.hpp"
+#include "threading/cache.hpp"
+#include "threading/spinlock.hpp"
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+
+
+namespace asyncpp {
+
+// A shared mutex for read-mostly data. Readers are counted in per-thread slots, each on its
+// own cache line, so uncontended readers of different threads don't share any memory. Writers
+// pay for this: they have to turn off the reader fast path and wait until all slots drain.
+//
+// A coroutine may unlock on a different thread than it locked on, so a single slot can go
+// negative: only the sum of the slots is the number of readers.
+//
+// When a writer unlocks, the readers that queued up behind it acquire the mutex before the
+// next writer, so neither readers nor writers starve.
+class distributed_shared_mutex {
+    enum class awaitable_type {
+        exclusive,
+        shared,
+        unknown,
+    };
+
+    struct basic_awaitable {
+        distributed_shared_mutex* m_owner = nullptr;
+        awaitable_type m_type = awaitable_type::unknown;
+        basic_awaitable* m_next = nullptr;
+        basic_awaitable* m_prev = nullptr;
+        resumable_promise* m_enclosing = nullptr;
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> enclosing) noexcept;
+    };
+
+    struct exclusive_awaitable : basic_awaitable {
+        explicit exclusive_awaitable(distributed_shared_mutex* owner = nullptr)
+            : basic_awaitable(owner, awaitable_type::exclusive) {}
+
+        bool await_ready() const noexcept;
+        exclusively_locked_mutex<distributed_shared_mutex> await_resume() const noexcept;
+    };
+
+    struct shared_awaitable : basic_awaitable {
+        explicit shared_awaitable(distributed_shared_mutex* owner = nullptr)
+            : basic_awaitable(owner, awaitable_type::shared) {}
+
+        bool await_ready() const noexcept;
+        shared_locked_mutex<distributed_shared_mutex> await_resume() const noexcept;
+    };
+
+    struct alignas(avoid_false_sharing) slot {
+        std::atomic<ptrdiff_t> m_readers = 0;
+    };
+
+    using queue_type = deque<basic_awaitable, &basic_awaitable::m_prev, &basic_awaitable::m_next>;
+
+    bool add_awaiting(basic_awaitable* waiting);
+    slot& local_slot() noexcept;
+    ptrdiff_t count_readers() const noexcept;
+    bool try_lock_shared_fast() noexcept;
+    void check_drained();
+    void start_writer(basic_awaitable* writer, queue_type& unblocked) noexcept;
+
+public:
+    // By default, there is a slot for each hardware thread.
+    explicit distributed_shared_mutex(size_t num_slots = 0);
+    distributed_shared_mutex(const distributed_shared_mutex&) = delete;
+    distributed_shared_mutex(distributed_shared_mutex&&) = delete;
+    distributed_shared_mutex& operator=(const distributed_shared_mutex&) = delete;
+    distributed_shared_mutex& operator=(distributed_shared_mutex&&) = delete;
+    ~distributed_shared_mutex();
+
+    bool try_lock() noexcept;
+    bool try_lock_shared() noexcept;
+    exclusive_awaitable exclusive() noexcept;
+    shared_awaitable shared() noexcept;
+    void unlock();
+    void unlock_shared();
+
+    bool _debug_is_exclusive_locked() const noexcept;
+    size_t _debug_is_shared_locked() const noexcept;
+
+private:
+    std::unique_ptr<slot[]> m_slots;
+    size_t m_num_slots;
+    // Set while a writer holds the mutex or waits for the readers to drain. Readers
+    // take the slow path while it's set.
+    alignas(avoid_false_sharing) std::atomic_bool m_writer_pending = false;
+    spinlock m_spinlock;
+    bool m_exclusive = false;
+    basic_awaitable* m_draining = nullptr;
+    queue_type m_exclusive_queue;
+    queue_type m_shared_queue;
+};
+
+
+template <std::convertible_to<const resumable_promise&> Promise>
+bool distributed_shared_mutex::basic_awaitable::await_suspend(std::coroutine_handle<Promise> enclosing) noexcept {
+    m_enclosing = &enclosing.promise();
+    assert(m_owner);
+    const bool ready = m_owner->add_awaiting(this);
+    return !ready;
+}
+
+
+} // namespace asyncpp
\ No newline at end of file
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "cancellation.hpp"
 #include "container/atomic_collection.hpp"
+#include "container/atomic_deque.hpp"
 #include "container/atomic_item.hpp"
 #include "promise.hpp"
+#include "threading/spinlock.hpp"
 
+#include <atomic>
 #include <cassert>
 #include <stdexcept>
 
@@ -17,6 +21,7 @@ public:
         basic_event* m_owner = nullptr;
         resumable_promise* m_enclosing = nullptr;
         awaitable* m_next = nullptr;
+        impl_cancellation::stop_listener<awaitable> m_listener = {};
 
         bool await_ready() const {
             assert(m_owner);
@@ -25,8 +30,17 @@ public:
 
         template <std::convertible_to<const resumable_promise&> Promise>
         bool await_suspend(std::coroutine_handle<Promise> promise) {
+            auto& enclosing = static_cast<resumable_promise&>(promise.promise());
+            auto token = impl_cancellation::get_stop_token(promise.promise());
+            if (!token.stop_possible()) {
+                return await_suspend(enclosing);
+            }
+            return await_suspend(*m_listener.intercept(enclosing)) && m_listener.listen(this, std::move(token));
+        }
+
+        bool await_suspend(resumable_promise& enclosing) {
             assert(m_owner);
-            m_enclosing = &promise.promise();
+            m_enclosing = &enclosing;
             const auto status = m_owner->m_awaiter.set(this);
             if (status != nullptr && !m_owner->m_awaiter.closed(status)) {
                 m_owner->m_awaiter.set(status);
@@ -37,9 +51,17 @@ public:
 
         T await_resume() {
             assert(m_owner);
+            if (m_listener.cancelled()) {
+                throw operation_cancelled();
+            }
             assert(m_owner->m_result.has_value());
             return static_cast<T>(m_owner->m_result.move_or_throw());
         }
+
+        bool try_cancel() noexcept {
+            assert(m_owner);
+            return m_owner->m_awaiter.remove(this);
+        }
     };
 
 public:
@@ -123,8 +145,12 @@ public:
 
         template <std::convertible_to<const resumable_promise&> Promise>
         bool await_suspend(std::coroutine_handle<Promise> promise) {
+            return await_suspend(static_cast<resumable_promise&>(promise.promise()));
+        }
+
+        bool await_suspend(resumable_promise& enclosing) {
             assert(m_owner);
-            m_enclosing = &promise.promise();
+            m_enclosing = &enclosing;
             const auto status = m_owner->m_awaiters.push(this);
             return !m_owner->m_awaiters.closed(status);
         }
@@ -201,4 +227,103 @@ public:
     }
 };
 
+
+// An event without a value that can be set and reset any number of times. Setting it resumes
+// all the coroutines that are waiting for it, and until it's reset, awaiting it doesn't suspend.
+class manual_reset_event {
+    struct awaitable {
+        manual_reset_event* m_owner = nullptr;
+        resumable_promise* m_enclosing = nullptr;
+        awaitable* m_next = nullptr;
+
+        bool await_ready() const noexcept;
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> promise) noexcept {
+            assert(m_owner);
+            m_enclosing = &promise.promise();
+            const auto status = m_owner->m_awaiters.push(this);
+            return !m_owner->m_awaiters.closed(status);
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+public:
+    explicit manual_reset_event(bool is_set = false) noexcept;
+    manual_reset_event(manual_reset_event&&) = delete;
+    manual_reset_event& operator=(manual_reset_event&&) = delete;
+    ~manual_reset_event();
+
+    void set() noexcept;
+    void reset() noexcept;
+    bool is_set() const noexcept;
+    awaitable operator co_await() noexcept;
+
+private:
+    // Closed while the event is set, otherwise it holds the waiting coroutines.
+    atomic_collection<awaitable, &awaitable::m_next> m_awaiters;
+};
+
+
+// An event without a value that resets itself when a coroutine gets through it. Setting it
+// resumes one waiting coroutine, or if there is none, lets the next coroutine through that
+// awaits it. Setting it again before that has no effect.
+class auto_reset_event {
+    struct awaitable {
+        auto_reset_event* m_owner = nullptr;
+        resumable_promise* m_enclosing = nullptr;
+        awaitable* m_prev = nullptr;
+        awaitable* m_next = nullptr;
+        impl_cancellation::stop_listener<awaitable> m_listener = {};
+
+        bool await_ready() const noexcept;
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> promise) noexcept {
+            assert(m_owner);
+            auto token = impl_cancellation::get_stop_token(promise.promise());
+            if (!token.stop_possible()) {
+                m_enclosing = &promise.promise();
+                return !m_owner->acquire_or_wait(this);
+            }
+            m_enclosing = m_listener.intercept(promise.promise());
+            return !m_owner->acquire_or_wait(this) && m_listener.listen(this, std::move(token));
+        }
+
+        void await_resume() const;
+
+        bool try_cancel() noexcept;
+    };
+
+public:
+    explicit auto_reset_event(bool is_set = false) noexcept;
+    auto_reset_event(auto_reset_event&&) = delete;
+    auto_reset_event& operator=(auto_reset_event&&) = delete;
+    ~auto_reset_event();
+
+    void set() noexcept;
+    void reset() noexcept;
+    bool is_set() const noexcept;
+    awaitable operator co_await() noexcept;
+
+private:
+    using queue_type = deque<awaitable, &awaitable::m_prev, &awaitable::m_next>;
+
+    bool try_acquire() noexcept;
+    bool acquire_or_wait(awaitable* waiting) noexcept;
+    bool set_waiting() noexcept;
+    bool remove_awaiting(awaitable* waiting) noexcept;
+
+private:
+    // The event can be set and reset without the lock as long as no coroutine is waiting.
+    // While the waiting bit is set, the state and the queue are only changed under the lock.
+    static constexpr size_t waiting_bit = 1;
+    static constexpr size_t set_bit = 2;
+
+    std::atomic<size_t> m_state;
+    spinlock m_spinlock;
+    queue_type m_awaiters;
+};
+
 } // namespace asyncpp
\ No newline at end of file
@@ -3,8 +3,13 @@
 #include "promise.hpp"
 
 #include <cassert>
+#include <concepts>
 #include <coroutine>
 #include <exception>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
 
 
 namespace asyncpp {
@@ -16,9 +21,102 @@ class generator;
 
 namespace impl_generator {
 
+    // Nested generators form a chain from the root to the innermost generator, the leaf, which
+    // is the only one that produces values. The root keeps track of the leaf, so the iterator
+    // resumes the leaf directly, regardless of the depth of the chain.
+    //
+    // Yielded values are not stored in the promise. The promise points to the yielded object,
+    // which lives in the frame of the coroutine while it's suspended.
+    template <class T>
+    struct promise_base {
+        using reference = std::conditional_t<std::is_reference_v<T>, T, T&>;
+        using pointer = std::add_pointer_t<reference>;
+
+        pointer m_value = nullptr;
+        std::exception_ptr m_exception;
+        std::coroutine_handle<> m_handle;
+        promise_base* m_parent = nullptr;
+        promise_base* m_root = this;
+        promise_base* m_leaf = this;
+
+        promise_base* root() noexcept {
+            auto root = m_root;
+            while (root->m_root != root) {
+                root = root->m_root;
+            }
+            return m_root = root;
+        }
+    };
+
+
+    struct final_awaitable {
+        constexpr bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <class Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept {
+            auto& promise = handle.promise();
+            if (promise.m_parent) {
+                promise.root()->m_leaf = promise.m_parent;
+                return promise.m_parent->m_handle;
+            }
+            return std::noop_coroutine();
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+
+    template <class T, class Alloc>
+    struct nested_awaitable {
+        generator<T, Alloc> m_generator;
+
+        bool await_ready() const noexcept {
+            return !m_generator.m_promise || m_generator.m_promise->m_handle.done();
+        }
+
+        template <std::derived_from<promise_base<T>> Promise>
+        void await_suspend(std::coroutine_handle<Promise> parent) const noexcept {
+            const auto child = static_cast<promise_base<T>*>(m_generator.m_promise);
+            const auto leaf = child->m_leaf;
+            child->m_parent = &parent.promise();
+            child->m_root = &parent.promise();
+            child->root()->m_leaf = leaf;
+        }
+
+        void await_resume() const {
+            // The nested generator either ran to completion or threw an exception.
+            if (m_generator.m_promise && m_generator.m_promise->m_exception) {
+                std::rethrow_exception(m_generator.m_promise->m_exception);
+            }
+        }
+    };
+
+
+    // Lvalues yielded from a generator of values are copied, so that the consumer
+    // cannot modify the variables of the generator through the iterator.
+    template <class T>
+    struct copy_awaitable {
+        T m_value;
+
+        constexpr bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <std::derived_from<promise_base<T>> Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            handle.promise().m_value = std::addressof(m_value);
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+
     template <class T, class Alloc>
-    struct promise : allocator_aware_promise<Alloc> {
+    struct promise : promise_base<T>, allocator_aware_promise<Alloc> {
         auto get_return_object() noexcept {
+            this->m_handle = std::coroutine_handle<promise>::from_promise(*this);
             return generator<T, Alloc>(this);
         }
 
@@ -27,51 +125,72 @@ namespace impl_generator {
         }
 
         constexpr auto final_suspend() const noexcept {
-            return std::suspend_always{};
+            return final_awaitable{};
         }
 
         void unhandled_exception() noexcept {
-            m_result = std::current_exception();
+            this->m_exception = std::current_exception();
         }
 
         void return_void() noexcept {}
 
-        auto yield_value(T value) noexcept {
-            m_result = std::forward<T>(value);
+        // Temporaries live until the coroutine is resumed, so they are not copied.
+        auto yield_value(std::conditional_t<std::is_reference_v<T>, T, T&&> value) noexcept {
+            this->m_value = std::addressof(value);
             return std::suspend_always{};
         }
 
-        task_result<T>& get_result() {
-            return m_result;
+        auto yield_value(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>)
+            requires(!std::is_reference_v<T>)
+        {
+            return copy_awaitable<T>{ value };
         }
 
-    private:
-        task_result<T> m_result;
+        template <class OtherAlloc>
+        auto yield_value(nested_awaitable<T, OtherAlloc>&& nested) noexcept {
+            return std::move(nested);
+        }
+
+        // The generator that currently produces values.
+        promise_base<T>& leaf() noexcept {
+            return *this->m_leaf;
+        }
+
+        void resume() {
+            this->m_leaf->m_handle.resume();
+        }
     };
 
     template <class T, class Alloc>
     class iterator {
     public:
         using promise_type = promise<T, Alloc>;
-        using value_type = std::remove_reference_t<T>;
+        using value_type = std::remove_cvref_t<T>;
         using difference_type = ptrdiff_t;
-        using pointer = value_type*;
-        using reference = value_type&;
+        using pointer = typename promise_base<T>::pointer;
+        using reference = typename promise_base<T>::reference;
         using iterator_category = std::input_iterator_tag;
+        using iterator_concept = std::input_iterator_tag;
 
         iterator() = default;
         explicit iterator(promise_type* promise) : m_promise(promise) {}
 
         reference operator*() const {
             assert(dereferenceable() && "iterator not dereferencable");
-            return m_promise->get_result().get_or_throw();
+            auto& leaf = m_promise->leaf();
+            if (leaf.m_exception) {
+                std::rethrow_exception(leaf.m_exception);
+            }
+            return static_cast<reference>(*leaf.m_value);
         }
 
         iterator& operator++() {
             assert(incrementable() && "iterator not incrementable");
-            m_promise->get_result().clear();
+            auto& leaf = m_promise->leaf();
+            leaf.m_value = nullptr;
+            leaf.m_exception = nullptr;
             if (!get_handle().done()) {
-                get_handle().resume();
+                m_promise->resume();
             }
             return *this;
         }
@@ -90,11 +209,12 @@ namespace impl_generator {
 
     private:
         bool dereferenceable() const noexcept {
-            return m_promise->get_result().has_value();
+            const auto& leaf = m_promise->leaf();
+            return leaf.m_value || leaf.m_exception;
         }
 
         bool incrementable() const noexcept {
-            return m_promise && m_promise->get_result().has_value();
+            return m_promise && dereferenceable();
         }
 
         auto get_handle() const noexcept {
@@ -106,12 +226,18 @@ namespace impl_generator {
     };
 
     static_assert(std::input_iterator<iterator<int, void>>);
+    static_assert(std::input_iterator<iterator<const int&, void>>);
 
 } // namespace impl_generator
 
 
+// Generators are views: they are move-only, and iterating them consumes the elements.
+// They are not borrowed ranges, as the iterators point into the generator's frame.
 template <class T, class Alloc = void>
-class [[nodiscard]] generator {
+class [[nodiscard]] generator : public std::ranges::view_base {
+    template <class, class>
+    friend struct impl_generator::nested_awaitable;
+
 public:
     using promise_type = impl_generator::promise<T, Alloc>;
     using iterator = impl_generator::iterator<T, Alloc>;
@@ -147,6 +273,18 @@ private:
 };
 
 
+static_assert(std::ranges::input_range<generator<int>>);
+static_assert(std::ranges::view<generator<int>>);
+
+
+// Yields all elements of a nested generator: `co_yield elements_of(walk(node->left));`.
+// The consumer of the outermost generator resumes the nested generator directly.
+template <class T, class Alloc>
+auto elements_of(generator<T, Alloc> nested) {
+    return impl_generator::nested_awaitable<T, Alloc>{ std::move(nested) };
+}
+
+
 template <class T>
 auto begin(const generator<T>& g) { return g.begin(); }
 
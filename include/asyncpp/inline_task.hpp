@@ -0,0 +1,135 @@
+#pragma once
+
+#include "cancellation.hpp"
+#include "promise.hpp"
+#include "scheduler.hpp"
+
+#include <cassert>
+#include <coroutine>
+#include <utility>
+
+
+namespace asyncpp {
+
+
+template <class T, class Alloc>
+class inline_task;
+
+
+namespace impl_inline_task {
+
+    template <class T, class Alloc>
+    struct promise : result_promise<T>, resumable_promise, schedulable_promise, stoppable_promise, allocator_aware_promise<Alloc> {
+        struct final_awaitable {
+            constexpr bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise> handle) const noexcept {
+                const auto continuation = handle.promise().m_continuation;
+                assert(continuation);
+                return continuation;
+            }
+            constexpr void await_resume() const noexcept {}
+        };
+
+        auto get_return_object() noexcept {
+            return inline_task<T, Alloc>(std::coroutine_handle<promise>::from_promise(*this));
+        }
+
+        constexpr auto initial_suspend() const noexcept {
+            return std::suspend_always{};
+        }
+
+        auto final_suspend() const noexcept {
+            return final_awaitable{};
+        }
+
+        void resume_now() final {
+            const auto handle = std::coroutine_handle<promise>::from_promise(*this);
+            handle.resume();
+        }
+
+        void resume() final {
+            return m_scheduler ? m_scheduler->schedule(*this) : resume_now();
+        }
+
+        std::coroutine_handle<> m_continuation = nullptr;
+    };
+
+
+    template <class T, class Alloc>
+    struct awaitable {
+        std::coroutine_handle<promise<T, Alloc>> m_handle;
+
+        constexpr bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <class Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> enclosing) noexcept {
+            auto& owner = m_handle.promise();
+            assert(!owner.m_continuation && "inline_task already awaited");
+            owner.m_continuation = enclosing;
+            if constexpr (std::convertible_to<Promise&, schedulable_promise&>) {
+                owner.m_scheduler = static_cast<schedulable_promise&>(enclosing.promise()).m_scheduler;
+            }
+            owner.m_stop_token = impl_cancellation::get_stop_token(enclosing.promise());
+            return m_handle;
+        }
+
+        T await_resume() {
+            return static_cast<T>(m_handle.promise().m_result.move_or_throw());
+        }
+    };
+
+} // namespace impl_inline_task
+
+
+// A task that is started by awaiting it and whose lifetime is strictly nested in
+// the awaiting coroutine. It runs on the awaiter's scheduler and stop token, and
+// hands control back by symmetric transfer. As the frame never escapes the awaiter,
+// compilers are free to elide its heap allocation.
+template <class T, class Alloc = void>
+class [[nodiscard]] inline_task {
+public:
+    using promise_type = impl_inline_task::promise<T, Alloc>;
+
+    inline_task() = default;
+    inline_task(const inline_task&) = delete;
+    inline_task& operator=(const inline_task&) = delete;
+    inline_task(inline_task&& rhs) noexcept : m_handle(std::exchange(rhs.m_handle, nullptr)) {}
+    inline_task& operator=(inline_task&& rhs) noexcept {
+        release();
+        m_handle = std::exchange(rhs.m_handle, nullptr);
+        return *this;
+    }
+    ~inline_task() {
+        release();
+    }
+    explicit inline_task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    bool valid() const {
+        return !!m_handle;
+    }
+
+    bool ready() const {
+        assert(valid());
+        return m_handle.done();
+    }
+
+    auto operator co_await() {
+        assert(valid());
+        return impl_inline_task::awaitable<T, Alloc>{ m_handle };
+    }
+
+private:
+    void release() {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle = nullptr;
+};
+
+
+} // namespace asyncpp
\ No newline at end of file
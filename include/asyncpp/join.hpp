@@ -3,59 +3,123 @@
 #include "concepts.hpp"
 #include "promise.hpp"
 #include "testing/suspension_point.hpp"
+#include "threading/cache.hpp"
 
+#include <atomic>
 #include <coroutine>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
-#include <future>
+#include <iterator>
+#include <type_traits>
+#include <utility>
 
 
 namespace asyncpp {
 
 namespace impl_join {
 
+    // Lives on the stack of the joining thread, the result is stored in place.
+    template <class T>
+    struct state {
+        task_result<T> m_result;
+        std::atomic_bool m_done = false;
+    };
+
+    // The state may be gone as soon as its flag is set, so the joining thread is notified
+    // through a counter that outlives it. Joins whose states map to the same counter may wake
+    // each other up spuriously.
+    struct alignas(avoid_false_sharing) notifier {
+        std::atomic<uint32_t> m_generation = 0;
+    };
+
+    inline notifier notifiers[64];
+
+    inline notifier& get_notifier(const void* state) noexcept {
+        return notifiers[reinterpret_cast<uintptr_t>(state) / alignof(std::max_align_t) % std::size(notifiers)];
+    }
+
+    inline void signal(std::atomic_bool& done) noexcept {
+        auto& notifier = get_notifier(&done);
+        done.store(true, std::memory_order_release);
+        notifier.m_generation.fetch_add(1, std::memory_order_release);
+        notifier.m_generation.notify_all();
+    }
+
+    inline void wait(const std::atomic_bool& done) noexcept {
+        auto& notifier = get_notifier(&done);
+        while (true) {
+            const auto generation = notifier.m_generation.load(std::memory_order_acquire);
+            if (done.load(std::memory_order_acquire)) {
+                return;
+            }
+            notifier.m_generation.wait(generation, std::memory_order_acquire);
+        }
+    }
+
+    template <class T>
+    struct promise;
+
     template <class T>
     struct joiner;
 
+    // The coroutine frame is destroyed before the joining thread is signalled, because
+    // the joining thread may return as soon as it sees the flag.
+    struct final_awaitable {
+        constexpr bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <class Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) const noexcept {
+            auto& done = handle.promise().m_state->m_done;
+            handle.destroy();
+            signal(done);
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
     template <class T>
     struct basic_promise : resumable_promise {
-        std::promise<T> m_promise;
+        state<T>* m_state = nullptr;
+
+        auto handle() noexcept {
+            return std::coroutine_handle<promise<T>>::from_promise(static_cast<promise<T>&>(*this));
+        }
 
         joiner<T> get_return_object() {
-            return { m_promise.get_future() };
+            return { handle() };
         }
 
         constexpr auto initial_suspend() const noexcept {
-            return std::suspend_never{};
+            return std::suspend_always{};
         }
 
         void unhandled_exception() noexcept {
-            m_promise.set_exception(std::current_exception());
+            m_state->m_result = std::current_exception();
         }
 
         constexpr auto final_suspend() const noexcept {
-            return std::suspend_never{};
+            return final_awaitable{};
+        }
+
+        void resume() noexcept override {
+            handle().resume();
         }
     };
 
     template <class T>
     struct promise : basic_promise<T> {
         void return_value(T value) noexcept {
-            this->m_promise.set_value(std::forward<T>(value));
-        }
-
-        void resume() noexcept override {
-            std::coroutine_handle<promise>::from_promise(*this).resume();
+            this->m_state->m_result = typename task_result<T>::value_type(std::forward<T>(value));
         }
     };
 
     template <>
     struct promise<void> : basic_promise<void> {
         void return_void() noexcept {
-            m_promise.set_value();
-        }
-
-        void resume() noexcept override {
-            std::coroutine_handle<promise>::from_promise(*this).resume();
+            m_state->m_result = nullptr;
         }
     };
 
@@ -63,24 +127,42 @@ namespace impl_join {
     struct joiner {
         using promise_type = promise<T>;
 
-        std::future<T> future;
+        std::coroutine_handle<promise_type> m_handle;
+
+        void start(state<T>& state) {
+            m_handle.promise().m_state = &state;
+            m_handle.resume();
+        }
     };
 
 } // namespace impl_join
 
 
+// Blocks the current thread until the awaitable completes, and returns its result. The
+// thread waits on an atomic counter, and no memory is allocated beside the coroutine frame.
 template <awaitable Awaitable>
 auto join(Awaitable&& object) -> await_result_t<std::remove_reference_t<Awaitable>> {
     using T = await_result_t<std::remove_reference_t<Awaitable>>;
-    auto joiner_ = [&object]() -> impl_join::joiner<T> {
+    impl_join::state<T> state;
+    // The coroutine starts after the lambda is gone, so it must not capture.
+    auto joiner_ = [](std::remove_reference_t<Awaitable>& object) -> impl_join::joiner<T> {
         co_return co_await object;
-    }();
+    }(object);
+    joiner_.start(state);
+    INTERLEAVED_ACQUIRE(impl_join::wait(state.m_done));
     if constexpr (std::is_void_v<T> || std::is_reference_v<T>) {
-        return INTERLEAVED_ACQUIRE(joiner_.future.get());
+        return state.m_result.get_or_throw();
     }
     else {
-        return std::forward<T>(INTERLEAVED_ACQUIRE(joiner_.future.get()));
+        return state.m_result.move_or_throw();
     }
 }
 
+
+// Same as `join`.
+template <awaitable Awaitable>
+auto sync_wait(Awaitable&& object) -> await_result_t<std::remove_reference_t<Awaitable>> {
+    return join(std::forward<Awaitable>(object));
+}
+
 } // namespace asyncpp
\ No newline at end of file
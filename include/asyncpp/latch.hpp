@@ -0,0 +1,55 @@
+#pragma once
+
+#include "container/atomic_collection.hpp"
+#include "promise.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+
+
+namespace asyncpp {
+
+// A single-use counter that coroutines can wait on until it has been counted down to zero,
+// similar to `std::latch`. All the waiting coroutines are resumed together.
+class latch {
+    struct awaitable {
+        latch* m_owner = nullptr;
+        resumable_promise* m_enclosing = nullptr;
+        awaitable* m_next = nullptr;
+
+        bool await_ready() const noexcept;
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> promise) noexcept {
+            assert(m_owner);
+            m_enclosing = &promise.promise();
+            const auto status = m_owner->m_awaiters.push(this);
+            return !m_owner->m_awaiters.closed(status);
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+public:
+    explicit latch(ptrdiff_t expected) noexcept;
+    latch(latch&&) = delete;
+    latch& operator=(latch&&) = delete;
+    ~latch();
+
+    void count_down(ptrdiff_t n = 1) noexcept;
+    bool try_wait() const noexcept;
+    awaitable wait() noexcept;
+    awaitable operator co_await() noexcept;
+    // Counts down immediately, the returned awaitable waits for the rest.
+    awaitable arrive_and_wait(ptrdiff_t n = 1) noexcept;
+
+private:
+    std::atomic<ptrdiff_t> m_counter;
+    // Closed when the counter reaches zero.
+    atomic_collection<awaitable, &awaitable::m_next> m_awaiters;
+};
+
+} // namespace asyncpp
\ No newline at end of file
@@ -3,13 +3,23 @@
 #include <cassert>
 #include <coroutine>
 #include <mutex>
+#include <type_traits>
 #include <utility>
 
 
 namespace asyncpp {
 
 
-template <class Mutex, bool Shared>
+// An upgradable lock coexists with shared locks, but not with exclusive or other upgradable
+// locks, and it can be upgraded to an exclusive lock without unlocking it first.
+enum class lock_mode {
+    exclusive,
+    shared,
+    upgradable,
+};
+
+
+template <class Mutex, lock_mode Mode>
 class basic_locked_mutex {
     friend Mutex;
 
@@ -29,12 +39,14 @@ private:
 
 
 template <class Mutex>
-using exclusively_locked_mutex = basic_locked_mutex<Mutex, false>;
+using exclusively_locked_mutex = basic_locked_mutex<Mutex, lock_mode::exclusive>;
 template <class Mutex>
-using shared_locked_mutex = basic_locked_mutex<Mutex, true>;
+using shared_locked_mutex = basic_locked_mutex<Mutex, lock_mode::shared>;
+template <class Mutex>
+using upgradably_locked_mutex = basic_locked_mutex<Mutex, lock_mode::upgradable>;
 
 
-template <class Mutex, bool Shared, auto Lock, bool (Mutex::*TryLock)(), void (Mutex::*Unlock)()>
+template <class Mutex, lock_mode Mode, auto Lock, bool (Mutex::*TryLock)(), void (Mutex::*Unlock)()>
 class basic_lock {
     // NOTE: GCC bugs out on `auto (Mutex::*Lock)()`, that's why `Lock` is simply `auto`.
 
@@ -53,7 +65,7 @@ class basic_lock {
             return m_impl.await_suspend(enclosing);
         }
 
-        void await_resume() noexcept {
+        void await_resume() {
             m_impl.await_resume();
             m_owner->m_owned = true;
         }
@@ -62,7 +74,7 @@ class basic_lock {
 public:
     basic_lock(Mutex& mtx, std::defer_lock_t) noexcept : m_mtx(&mtx), m_owned(false) {}
     basic_lock(Mutex& mtx, std::adopt_lock_t) noexcept : m_mtx(&mtx), m_owned(true) {}
-    basic_lock(basic_locked_mutex<Mutex, Shared>&& lk) noexcept : m_mtx(&lk.mutex()), m_owned(true) {}
+    basic_lock(basic_locked_mutex<Mutex, Mode>&& lk) noexcept : m_mtx(&lk.mutex()), m_owned(true) {}
     basic_lock(basic_lock&& rhs) noexcept : m_mtx(rhs.m_mtx), m_owned(rhs.m_owned) {
         rhs.m_mtx = nullptr;
         rhs.m_owned = false;
@@ -104,6 +116,12 @@ public:
         return *m_mtx;
     }
 
+    // Disassociates the mutex without unlocking it.
+    Mutex* release() noexcept {
+        m_owned = false;
+        return std::exchange(m_mtx, nullptr);
+    }
+
     bool owns_lock() const noexcept {
         return m_owned;
     }
@@ -119,13 +137,50 @@ private:
 
 
 template <class Mutex>
-class unique_lock : public basic_lock<Mutex, false, &Mutex::exclusive, &Mutex::try_lock, &Mutex::unlock> {
-    using basic_lock<Mutex, false, &Mutex::exclusive, &Mutex::try_lock, &Mutex::unlock>::basic_lock;
+class unique_lock : public basic_lock<Mutex, lock_mode::exclusive, &Mutex::exclusive, &Mutex::try_lock, &Mutex::unlock> {
+    using basic_lock<Mutex, lock_mode::exclusive, &Mutex::exclusive, &Mutex::try_lock, &Mutex::unlock>::basic_lock;
 };
 
 template <class Mutex>
-class shared_lock : public basic_lock<Mutex, true, &Mutex::shared, &Mutex::try_lock_shared, &Mutex::unlock_shared> {
-    using basic_lock<Mutex, true, &Mutex::shared, &Mutex::try_lock_shared, &Mutex::unlock_shared>::basic_lock;
+class shared_lock : public basic_lock<Mutex, lock_mode::shared, &Mutex::shared, &Mutex::try_lock_shared, &Mutex::unlock_shared> {
+    using basic_lock<Mutex, lock_mode::shared, &Mutex::shared, &Mutex::try_lock_shared, &Mutex::unlock_shared>::basic_lock;
+};
+
+
+template <class Mutex>
+class upgrade_lock : public basic_lock<Mutex, lock_mode::upgradable, &Mutex::upgradable, &Mutex::try_lock_upgradable, &Mutex::unlock_upgradable> {
+    using base = basic_lock<Mutex, lock_mode::upgradable, &Mutex::upgradable, &Mutex::try_lock_upgradable, &Mutex::unlock_upgradable>;
+    using upgrade_awaitable_t = std::invoke_result_t<decltype(&Mutex::upgrade), Mutex*>;
+
+    struct awaitable {
+        upgrade_lock* m_owner;
+        upgrade_awaitable_t m_impl;
+
+        auto await_ready() noexcept {
+            return m_impl.await_ready();
+        }
+
+        template <class Promise>
+        auto await_suspend(std::coroutine_handle<Promise> enclosing) noexcept {
+            return m_impl.await_suspend(enclosing);
+        }
+
+        unique_lock<Mutex> await_resume() {
+            auto locked = m_impl.await_resume();
+            m_owner->release();
+            return unique_lock<Mutex>(std::move(locked));
+        }
+    };
+
+public:
+    using base::base;
+
+    // Upgrades the lock to an exclusive lock without unlocking it. The exclusive lock
+    // is returned, and this lock no longer owns the mutex: `auto lk = co_await ulk.upgrade();`.
+    auto upgrade() noexcept {
+        assert(this->owns_lock());
+        return awaitable{ this, this->mutex().upgrade() };
+    }
 };
 
 
@@ -145,4 +200,12 @@ template <class Mutex>
 shared_lock(Mutex&, std::defer_lock_t) -> shared_lock<Mutex>;
 
 
+template <class Mutex>
+upgrade_lock(upgradably_locked_mutex<Mutex>) -> upgrade_lock<Mutex>;
+template <class Mutex>
+upgrade_lock(Mutex&, std::adopt_lock_t) -> upgrade_lock<Mutex>;
+template <class Mutex>
+upgrade_lock(Mutex&, std::defer_lock_t) -> upgrade_lock<Mutex>;
+
+
 } // namespace asyncpp
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cancellation.hpp"
 #include "container/atomic_deque.hpp"
 #include "lock.hpp"
 #include "promise.hpp"
@@ -11,21 +12,28 @@
 namespace asyncpp {
 
 class mutex {
+    // Moves the coroutines it notifies directly to the queue of the mutex.
+    friend class condition_variable;
+
     struct awaitable {
         mutex* m_owner = nullptr;
         resumable_promise* m_enclosing = nullptr;
         awaitable* m_next = nullptr;
         awaitable* m_prev = nullptr;
+        impl_cancellation::stop_listener<awaitable> m_listener = {};
 
         bool await_ready() const noexcept;
 
         template <std::convertible_to<const resumable_promise&> Promise>
         bool await_suspend(std::coroutine_handle<Promise> enclosing) noexcept;
 
-        exclusively_locked_mutex<mutex> await_resume() noexcept;
+        exclusively_locked_mutex<mutex> await_resume();
+
+        bool try_cancel() noexcept;
     };
 
     bool add_awaiting(awaitable* waiting);
+    bool remove_awaiting(awaitable* waiting) noexcept;
 
 public:
     mutex() = default;
@@ -56,9 +64,15 @@ private:
 template <std::convertible_to<const resumable_promise&> Promise>
 bool mutex::awaitable::await_suspend(std::coroutine_handle<Promise> enclosing) noexcept {
     assert(m_owner);
-    m_enclosing = &enclosing.promise();
+    auto token = impl_cancellation::get_stop_token(enclosing.promise());
+    if (!token.stop_possible()) {
+        m_enclosing = &enclosing.promise();
+        const bool ready = m_owner->add_awaiting(this);
+        return !ready;
+    }
+    m_enclosing = m_listener.intercept(enclosing.promise());
     const bool ready = m_owner->add_awaiting(this);
-    return !ready;
+    return !ready && m_listener.listen(this, std::move(token));
 }
 
 } // namespace asyncpp
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <cstddef>
 #include <memory>
 #include <optional>
+#include <stop_token>
 #include <utility>
 #include <variant>
 
@@ -79,6 +80,11 @@ struct schedulable_promise {
 };
 
 
+struct stoppable_promise {
+    std::stop_token m_stop_token;
+};
+
+
 template <class T>
 struct result_promise {
     task_result<T> m_result;
@@ -115,46 +121,83 @@ private:
 
     using dealloc_t = void (*)(void*, size_t);
 
+    static constexpr size_t round_up(size_t size, size_t alignment) {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
     static constexpr auto dealloc_offset(size_t size) {
-        constexpr auto dealloc_alignment = alignof(dealloc_t);
-        return (size + dealloc_alignment - 1) / dealloc_alignment * dealloc_alignment;
+        return round_up(size, alignof(dealloc_t));
     }
 
+    // Describes the memory block of a coroutine frame: the frame itself, followed by
+    // the deallocator's address if the allocator is type-erased, followed by a copy of
+    // the allocator if it's stateful. Stateless allocators are default-constructed
+    // when the frame is released, so they need no storage at all.
+    template <class Alloc_, size_t Alignment, bool Erased>
+    struct frame_layout {
+        static constexpr size_t alignment = Alignment;
+        using block_t = aligned_block<Alignment>;
+        using alloc_t = typename std::allocator_traits<Alloc_>::template rebind_alloc<block_t>;
+
+        static constexpr bool stateless = std::allocator_traits<alloc_t>::is_always_equal::value
+                                          && std::is_default_constructible_v<alloc_t>;
+
+        static constexpr size_t alloc_offset(size_t size) {
+            const auto extended_size = Erased ? dealloc_offset(size) + sizeof(dealloc_t) : size;
+            return stateless ? extended_size : round_up(extended_size, alignof(alloc_t));
+        }
+
+        static constexpr size_t num_blocks(size_t size) {
+            const auto total_size = alloc_offset(size) + (stateless ? 0 : sizeof(alloc_t));
+            return (total_size + sizeof(block_t) - 1) / sizeof(block_t);
+        }
+
+        static void* allocate(size_t size, const Alloc_& alloc) {
+            auto rebound_alloc = alloc_t(alloc);
+            const auto ptr = std::allocator_traits<alloc_t>::allocate(rebound_alloc, num_blocks(size));
+            if constexpr (Erased) {
+                const auto dealloc_ptr = reinterpret_cast<dealloc_t*>(reinterpret_cast<std::byte*>(ptr) + dealloc_offset(size));
+                new (dealloc_ptr) dealloc_t(&deallocate);
+            }
+            if constexpr (!stateless) {
+                const auto alloc_ptr = reinterpret_cast<alloc_t*>(reinterpret_cast<std::byte*>(ptr) + alloc_offset(size));
+                new (alloc_ptr) alloc_t(std::move(rebound_alloc));
+            }
+            return ptr;
+        }
+
+        static void deallocate(void* ptr, size_t size) {
+            if constexpr (stateless) {
+                auto alloc = alloc_t{};
+                std::allocator_traits<alloc_t>::deallocate(alloc, static_cast<block_t*>(ptr), num_blocks(size));
+            }
+            else {
+                const auto alloc_ptr = reinterpret_cast<alloc_t*>(static_cast<std::byte*>(ptr) + alloc_offset(size));
+                auto alloc = std::move(*alloc_ptr);
+                alloc_ptr->~alloc_t();
+                std::allocator_traits<alloc_t>::deallocate(alloc, static_cast<block_t*>(ptr), num_blocks(size));
+            }
+        }
+    };
+
+    // The layout for a fixed allocator type must be recoverable in operator delete
+    // from the frame size alone, thus it cannot depend on the coroutine's arguments. Arguments
+    // that need a stricter alignment than the layout's are rejected at compile time.
+    template <class Alloc_>
+    using fixed_layout = frame_layout<Alloc_, std::max(alignof(std::max_align_t), alignof(Alloc_)), false>;
+
     template <class Alloc_, class... Args>
         requires std::convertible_to<Alloc_, Alloc> || std::is_void_v<Alloc>
     static void* allocate(size_t size, std::allocator_arg_t, const Alloc_& alloc, Args&&...) {
-        static constexpr auto alloc_alignment = alignof(Alloc_);
-        static constexpr auto promise_alignment = std::max({ alignof(std::max_align_t), alignof(Args)... });
-        static constexpr auto alignment = std::max(alloc_alignment, promise_alignment);
-        using block_t = aligned_block<alignment>;
-        using alloc_t = typename std::allocator_traits<Alloc_>::template rebind_alloc<block_t>;
-        static_assert(alignof(alloc_t) <= alignof(Alloc_));
-
-        static constexpr auto alloc_offset = [](size_t size) {
-            const auto extended_size = dealloc_offset(size) + sizeof(dealloc_t);
-            return (extended_size + alloc_alignment - 1) / alloc_alignment * alloc_alignment;
-        };
-
-        static constexpr auto total_size = [](size_t size) {
-            return alloc_offset(size) + sizeof(alloc_t);
-        };
-
-        static constexpr dealloc_t dealloc = [](void* ptr, size_t size) {
-            const auto alloc_ptr = reinterpret_cast<alloc_t*>(static_cast<std::byte*>(ptr) + alloc_offset(size));
-            auto alloc = std::move(*alloc_ptr);
-            alloc_ptr->~alloc_t();
-            const auto num_blocks = (total_size(size) + sizeof(block_t) - 1) / sizeof(block_t);
-            std::allocator_traits<alloc_t>::deallocate(alloc, static_cast<block_t*>(ptr), num_blocks);
-        };
-
-        auto rebound_alloc = alloc_t(alloc);
-        const auto num_blocks = (total_size(size) + sizeof(block_t) - 1) / sizeof(block_t);
-        const auto ptr = std::allocator_traits<alloc_t>::allocate(rebound_alloc, num_blocks);
-        const auto dealloc_ptr = reinterpret_cast<dealloc_t*>(reinterpret_cast<std::byte*>(ptr) + dealloc_offset(size));
-        const auto alloc_ptr = reinterpret_cast<alloc_t*>(reinterpret_cast<std::byte*>(ptr) + alloc_offset(size));
-        new (dealloc_ptr) dealloc_t(dealloc);
-        new (alloc_ptr) alloc_t(std::move(rebound_alloc));
-        return ptr;
+        static constexpr auto alignment = std::max({ alignof(Alloc_), alignof(std::max_align_t), alignof(Args)... });
+        if constexpr (std::is_void_v<Alloc>) {
+            return frame_layout<Alloc_, alignment, true>::allocate(size, alloc);
+        }
+        else {
+            static_assert(std::max({ alignof(std::max_align_t), alignof(Args)... }) <= fixed_layout<Alloc>::alignment,
+                          "over-aligned coroutine arguments require a type-erased allocator");
+            return fixed_layout<Alloc>::allocate(size, Alloc(alloc));
+        }
     }
 
 public:
@@ -182,8 +225,13 @@ public:
     }
 
     void operator delete(void* ptr, size_t size) {
-        const auto dealloc_ptr = reinterpret_cast<dealloc_t*>(static_cast<std::byte*>(ptr) + dealloc_offset(size));
-        (*dealloc_ptr)(ptr, size);
+        if constexpr (std::is_void_v<Alloc>) {
+            const auto dealloc_ptr = reinterpret_cast<dealloc_t*>(static_cast<std::byte*>(ptr) + dealloc_offset(size));
+            (*dealloc_ptr)(ptr, size);
+        }
+        else {
+            fixed_layout<Alloc>::deallocate(ptr, size);
+        }
     }
 };
 
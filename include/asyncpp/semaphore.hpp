@@ -1,9 +1,11 @@
 #pragma once
 
+#include "cancellation.hpp"
 #include "container/atomic_deque.hpp"
 #include "promise.hpp"
 #include "threading/spinlock.hpp"
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 
@@ -14,28 +16,42 @@ namespace asyncpp {
 class counting_semaphore {
     struct awaitable {
         counting_semaphore* m_owner = nullptr;
+        ptrdiff_t m_count = 1;
         resumable_promise* m_enclosing = nullptr;
         awaitable* m_prev = nullptr;
         awaitable* m_next = nullptr;
+        bool m_queued = false;
+        impl_cancellation::stop_listener<awaitable> m_listener = {};
 
         bool await_ready() const noexcept;
 
         template <std::convertible_to<const resumable_promise&> Promise>
         bool await_suspend(std::coroutine_handle<Promise> promise) noexcept {
             assert(m_owner);
-            m_enclosing = &promise.promise();
-            return !m_owner->acquire(this);
+            auto token = impl_cancellation::get_stop_token(promise.promise());
+            if (!token.stop_possible()) {
+                m_enclosing = &promise.promise();
+                return !m_owner->acquire_or_wait(this);
+            }
+            m_enclosing = m_listener.intercept(promise.promise());
+            return !m_owner->acquire_or_wait(this) && m_listener.listen(this, std::move(token));
         }
 
-        constexpr void await_resume() const noexcept {}
+        void await_resume() const;
+
+        bool try_cancel() noexcept;
     };
 
 public:
     explicit counting_semaphore(ptrdiff_t current_counter = 0, ptrdiff_t max_counter = std::numeric_limits<ptrdiff_t>::max()) noexcept;
 
-    bool try_acquire() noexcept;
+    bool try_acquire(ptrdiff_t count = 1) noexcept;
+    // Waits until `count` units are available. Waiting coroutines acquire the semaphore in FIFO
+    // order, so a coroutine that needs many units is not starved by those that need few.
+    awaitable acquire(ptrdiff_t count = 1) noexcept;
     awaitable operator co_await() noexcept;
-    void release() noexcept;
+    // Resumes all the waiting coroutines that the released units cover at once.
+    void release(ptrdiff_t count = 1) noexcept;
     ptrdiff_t max() const noexcept;
 
     ptrdiff_t _debug_get_counter() const noexcept;
@@ -43,12 +59,24 @@ public:
     void _debug_clear();
 
 private:
-    bool acquire(awaitable* waiting) noexcept;
+    using queue_type = deque<awaitable, &awaitable::m_prev, &awaitable::m_next>;
+
+    bool acquire_or_wait(awaitable* waiting) noexcept;
+    void release_waiting(ptrdiff_t count) noexcept;
+    bool remove_awaiting(awaitable* waiting) noexcept;
+    void collect_ready(queue_type& ready) noexcept;
+    static void resume_all(queue_type& ready) noexcept;
 
 private:
+    // The counter is stored shifted left by one, the lowest bit is set when there are awaiters.
+    // The counter can be changed without the lock as long as the bit is clear. While the bit is
+    // set, the counter, the bit and the queue are only changed under the lock.
+    static constexpr size_t waiting_bit = 1;
+    static constexpr size_t counter_unit = 2;
+
+    std::atomic<size_t> m_state;
     spinlock m_spinlock;
-    deque<awaitable, &awaitable::m_prev, &awaitable::m_next> m_awaiters;
-    ptrdiff_t m_counter = 0;
+    queue_type m_awaiters;
     const ptrdiff_t m_max;
 };
 
@@ -6,15 +6,33 @@
 #include "threading/spinlock.hpp"
 
 #include <concepts>
+#include <cstdint>
+#include <mutex>
 #include <optional>
 
 
 namespace asyncpp {
 
+// Decides who acquires a shared_mutex when both readers and writers are waiting.
+enum class shared_mutex_policy {
+    // Coroutines acquire the mutex in the order they started waiting, adjacent readers together.
+    fifo,
+    // Readers join the holders of the shared lock even if writers are waiting. Writers may starve.
+    reader_preferring,
+    // Readers wait while writers are waiting, and writers go first. Readers may starve.
+    writer_preferring,
+    // Readers wait while writers are waiting. When a writer unlocks, all waiting readers
+    // go next, then the next writer, so readers and writers alternate in batches.
+    phase_fair,
+};
+
+
 class shared_mutex {
     enum class awaitable_type {
         exclusive,
         shared,
+        upgradable,
+        upgrade,
         unknown,
     };
 
@@ -24,6 +42,7 @@ class shared_mutex {
         basic_awaitable* m_next = nullptr;
         basic_awaitable* m_prev = nullptr;
         resumable_promise* m_enclosing = nullptr;
+        uint64_t m_ticket = 0;
 
         template <std::convertible_to<const resumable_promise&> Promise>
         bool await_suspend(std::coroutine_handle<Promise> enclosing) noexcept;
@@ -45,11 +64,35 @@ class shared_mutex {
         shared_locked_mutex<shared_mutex> await_resume() const noexcept;
     };
 
+    struct upgradable_awaitable : basic_awaitable {
+        explicit upgradable_awaitable(shared_mutex* owner = nullptr)
+            : basic_awaitable(owner, awaitable_type::upgradable) {}
+
+        bool await_ready() const noexcept;
+        upgradably_locked_mutex<shared_mutex> await_resume() const noexcept;
+    };
+
+    struct upgrade_awaitable : basic_awaitable {
+        explicit upgrade_awaitable(shared_mutex* owner = nullptr)
+            : basic_awaitable(owner, awaitable_type::upgrade) {}
+
+        bool await_ready() const noexcept;
+        exclusively_locked_mutex<shared_mutex> await_resume() const noexcept;
+    };
+
+    using queue_type = deque<basic_awaitable, &basic_awaitable::m_prev, &basic_awaitable::m_next>;
+
     bool add_awaiting(basic_awaitable* waiting);
-    void continue_waiting(std::unique_lock<spinlock>& lk);
+    bool can_lock() const noexcept;
+    bool can_lock_shared() const noexcept;
+    bool can_lock_upgradable() const noexcept;
+    bool upgrade_now() noexcept;
+    void continue_waiting(std::unique_lock<spinlock>& lk, bool after_exclusive);
+    void unblock_exclusive(queue_type& unblocked) noexcept;
+    void unblock_shared(queue_type& unblocked) noexcept;
 
 public:
-    shared_mutex() = default;
+    explicit shared_mutex(shared_mutex_policy policy = shared_mutex_policy::fifo) noexcept;
     shared_mutex(const shared_mutex&) = delete;
     shared_mutex(shared_mutex&&) = delete;
     shared_mutex& operator=(const shared_mutex&) = delete;
@@ -62,17 +105,33 @@ public:
     shared_awaitable shared() noexcept;
     void unlock();
     void unlock_shared();
+    shared_mutex_policy policy() const noexcept;
+
+    // The holder of the upgradable lock may upgrade it to an exclusive lock. The upgrade waits
+    // for the current readers to unlock, and new readers wait for the upgrade.
+    bool try_lock_upgradable() noexcept;
+    upgradable_awaitable upgradable() noexcept;
+    void unlock_upgradable();
+    bool try_upgrade() noexcept;
+    upgrade_awaitable upgrade() noexcept;
 
     void _debug_clear() noexcept;
     bool _debug_is_exclusive_locked() const noexcept;
     size_t _debug_is_shared_locked() const noexcept;
+    bool _debug_is_upgradable_locked() const noexcept;
 
 private:
-    deque<basic_awaitable, &basic_awaitable::m_prev, &basic_awaitable::m_next> m_queue;
+    // Waiting writers and readers are queued separately, the tickets tell their relative order.
+    queue_type m_exclusive_queue;
+    queue_type m_shared_queue;
+    queue_type m_upgradable_queue;
+    uint64_t m_next_ticket = 0;
     spinlock m_spinlock;
-    exclusive_awaitable m_exclusive_sentinel;
-    shared_awaitable m_shared_sentinel;
+    bool m_exclusive = false;
+    bool m_upgradable = false;
+    basic_awaitable* m_upgrading = nullptr;
     size_t m_shared_count = 0;
+    const shared_mutex_policy m_policy;
 };
 
 
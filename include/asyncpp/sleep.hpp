@@ -1,10 +1,18 @@
 #pragma once
 
+#include "cancellation.hpp"
+#include "container/timer_wheel.hpp"
 #include "promise.hpp"
+#include "threading/cache.hpp"
+#include "threading/spinlock.hpp"
 
+#include <atomic>
+#include <bit>
 #include <chrono>
 #include <concepts>
 #include <coroutine>
+#include <cstdint>
+#include <memory>
 
 
 namespace asyncpp {
@@ -13,42 +21,126 @@ namespace impl_sleep {
 
     using clock_type = std::chrono::steady_clock;
 
+    class timer_queue;
+
+
+    // Picks the tick a timer fires at out of the window [earliest, latest] it may fire in. The tick
+    // with the most trailing zeros is picked so that the timers of overlapping windows fire
+    // together. The tick is then rounded up to a multiple of the global granularity.
+    constexpr uint64_t coalesce(uint64_t earliest, uint64_t latest, uint64_t granularity) noexcept {
+        auto due = earliest;
+        if (earliest < latest) {
+            const auto unaligned = (uint64_t(1) << (std::bit_width(earliest ^ latest) - 1)) - 1;
+            due = latest & ~unaligned;
+        }
+        return (due + granularity - 1) / granularity * granularity;
+    }
+
+
     struct awaitable {
         resumable_promise* m_enclosing = nullptr;
+        // Bookkeeping of the timer queues.
+        awaitable* m_prev = nullptr;
+        awaitable* m_next = nullptr;
+        uint64_t m_tick = 0;
+        size_t m_slot = 0;
+        timer_queue* m_queue = nullptr;
 
-        explicit awaitable(clock_type::time_point time) noexcept;
+        explicit awaitable(clock_type::time_point time, clock_type::duration slack = {}) noexcept;
 
         bool await_ready() const noexcept;
         template <std::convertible_to<const resumable_promise&> Promise>
-        void await_suspend(std::coroutine_handle<Promise> enclosing) noexcept;
-        void await_resume() const noexcept;
+        bool await_suspend(std::coroutine_handle<Promise> enclosing) noexcept;
+        void await_resume() const;
         auto get_time() const noexcept -> clock_type::time_point;
+        auto get_slack() const noexcept -> clock_type::duration;
+        bool try_cancel() noexcept;
 
     private:
         void enqueue() noexcept;
         clock_type::time_point m_time;
+        clock_type::duration m_slack;
+        impl_cancellation::stop_listener<awaitable> m_listener;
     };
 
     template <std::convertible_to<const resumable_promise&> Promise>
-    void awaitable::await_suspend(std::coroutine_handle<Promise> enclosing) noexcept {
-        m_enclosing = &enclosing.promise();
+    bool awaitable::await_suspend(std::coroutine_handle<Promise> enclosing) noexcept {
+        auto token = impl_cancellation::get_stop_token(enclosing.promise());
+        if (!token.stop_possible()) {
+            m_enclosing = &enclosing.promise();
+            enqueue();
+            return true;
+        }
+        m_enclosing = m_listener.intercept(enclosing.promise());
         enqueue();
+        return m_listener.listen(this, std::move(token));
     }
 
+
+    // Fires the timers of the coroutines that go to sleep on a thread. Threads that run
+    // their own event loop, such as the workers of a thread_pool, can install a queue
+    // for themselves to fire the timers locally. Other threads share the queues of a
+    // background thread.
+    class alignas(avoid_false_sharing) timer_queue {
+        friend class sleep_scheduler;
+
+        struct retire {
+            void operator()(timer_queue* queue) const noexcept;
+        };
+
+    public:
+        using wheel_type = timer_wheel<awaitable, &awaitable::m_prev, &awaitable::m_next, &awaitable::m_tick, &awaitable::m_slot>;
+        // Cancellation may still lock a queue after the timer has been handed over to another
+        // queue, so queues of event loops are never freed. When the handle is released, the
+        // pending timers are handed over to the background thread, which keeps the queue for reuse.
+        using handle = std::unique_ptr<timer_queue, retire>;
+
+        timer_queue() = default;
+        timer_queue(const timer_queue&) = delete;
+        timer_queue& operator=(const timer_queue&) = delete;
+
+        static handle create();
+        static timer_queue* local() noexcept;
+        static void install(timer_queue* queue) noexcept;
+
+        uint64_t insert(awaitable* awaiter) noexcept;
+        static bool remove(awaitable* awaiter) noexcept;
+
+        // Resumes the coroutines whose timers have expired.
+        void expire();
+        // The deadline of the earliest timer, or the maximum time point if there are none.
+        clock_type::time_point next_deadline() const noexcept;
+
+    private:
+        void collect(uint64_t now, wheel_type::list& expired) noexcept;
+
+    private:
+        mutable spinlock m_mutex;
+        wheel_type m_wheel;
+        std::atomic<uint64_t> m_next_tick = wheel_type::never;
+        inline static thread_local timer_queue* m_local = nullptr;
+    };
+
 } // namespace impl_sleep
 
 
+// The coroutine may be woken up as late as `slack` after the duration has elapsed,
+// which lets the timers of many coroutines be fired together.
 template <class Rep, class Period>
-auto sleep_for(std::chrono::duration<Rep, Period> duration) {
+auto sleep_for(std::chrono::duration<Rep, Period> duration, impl_sleep::clock_type::duration slack = {}) {
     using impl_sleep::clock_type;
-    return impl_sleep::awaitable{ clock_type::now() + duration };
+    return impl_sleep::awaitable{ clock_type::now() + duration, slack };
 }
 
 
 template <class Clock, class Dur>
-auto sleep_until(std::chrono::time_point<Clock, Dur> time_point) {
+auto sleep_until(std::chrono::time_point<Clock, Dur> time_point, impl_sleep::clock_type::duration slack = {}) {
     using impl_sleep::clock_type;
-    return impl_sleep::awaitable{ std::chrono::clock_cast<clock_type>(time_point) };
+    return impl_sleep::awaitable{ std::chrono::clock_cast<clock_type>(time_point), slack };
 }
 
+
+// Rounds up the wake-up time of all sleeping coroutines to a multiple of `granularity`.
+void set_sleep_granularity(impl_sleep::clock_type::duration granularity) noexcept;
+
 } // namespace asyncpp
\ No newline at end of file
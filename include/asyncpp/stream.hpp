@@ -1,14 +1,22 @@
 #pragma once
 
+#include "cancellation.hpp"
 #include "event.hpp"
 #include "memory/rc_ptr.hpp"
 #include "promise.hpp"
 #include "scheduler.hpp"
+#include "threading/spinlock.hpp"
 
 #include <coroutine>
 #include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <stop_token>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 
 namespace asyncpp {
@@ -61,17 +69,45 @@ namespace impl_stream {
 
 
     template <class T, class Alloc>
-    struct promise : resumable_promise, schedulable_promise, rc_from_this, allocator_aware_promise<Alloc> {
+    struct promise : resumable_promise, schedulable_promise, stoppable_promise, rc_from_this, allocator_aware_promise<Alloc> {
+        using result_type = task_result<std::optional<wrapper_type<T>>>;
+
+        // Buffered streams run ahead of the consumer by up to the size of the buffer.
+        struct buffer {
+            explicit buffer(size_t size) : m_items(size) {}
+
+            spinlock m_mutex;
+            std::vector<result_type> m_items;
+            size_t m_front = 0;
+            size_t m_size = 0;
+            bool m_producer_waiting = false;
+            bool m_finished = false;
+            resumable_promise* m_consumer = nullptr;
+        };
+
+        template <bool Final>
         struct yield_awaitable {
             constexpr bool await_ready() const noexcept { return false; }
 
-            void await_suspend(std::coroutine_handle<promise> handle) const noexcept {
+            bool await_suspend(std::coroutine_handle<promise> handle) const noexcept {
                 auto& owner = handle.promise();
-                assert(owner.m_event);
                 assert(owner.m_result.has_value());
+                if (owner.m_buffer) {
+                    const auto waiting = owner.push(Final);
+                    if constexpr (Final) {
+                        auto self = std::move(owner.m_self);
+                        self.reset();
+                        return true;
+                    }
+                    return waiting;
+                }
+                assert(owner.m_event);
+                // The reference is taken before setting the event, as the consumer may restart the stream
+                // right after. owner.m_self.reset() would call method on owner after it's been deleted.
+                auto self = std::move(owner.m_self);
                 owner.m_event->set(std::move(owner.m_result));
-                auto self = std::move(owner.m_self); // owner.m_self.reset() would call method on owner after it's been deleted.
                 self.reset();
+                return true;
             }
 
             constexpr void await_resume() const noexcept {}
@@ -85,11 +121,11 @@ namespace impl_stream {
             return {};
         }
 
-        yield_awaitable final_suspend() const noexcept {
+        yield_awaitable<true> final_suspend() const noexcept {
             return {};
         }
 
-        yield_awaitable yield_value(T value) noexcept {
+        yield_awaitable<false> yield_value(T value) noexcept {
             m_result = std::optional(wrapper_type<T>(std::forward<T>(value)));
             return {};
         }
@@ -102,10 +138,16 @@ namespace impl_stream {
             m_result = std::nullopt;
         }
 
-        void start() noexcept {
+        // The stream inherits the stop token of the coroutine that first resumes it, unless it has its own.
+        void start(std::stop_token token = {}) noexcept {
             if (!INTERLEAVED(m_started.test_and_set())) {
+                if (!m_stop_token.stop_possible()) {
+                    m_stop_token = std::move(token);
+                }
                 m_self.reset(this);
-                m_event.emplace();
+                if (!m_buffer) {
+                    m_event.emplace();
+                }
                 resume();
             }
         }
@@ -115,6 +157,10 @@ namespace impl_stream {
         }
 
         bool ready() const {
+            if (m_buffer) {
+                std::lock_guard lk(m_buffer->m_mutex);
+                return m_buffer->m_size != 0 || m_buffer->m_finished;
+            }
             return m_event && m_event->ready();
         }
 
@@ -132,17 +178,73 @@ namespace impl_stream {
             handle.destroy();
         }
 
-        auto await() noexcept;
+        auto await(std::stop_token token) noexcept;
 
         bool has_event() const noexcept {
             return !!m_event;
         }
 
+        bool buffered() const noexcept {
+            return !!m_buffer;
+        }
+
+        void set_buffer_size(size_t size) {
+            m_buffer = size != 0 ? std::make_unique<buffer>(size) : nullptr;
+        }
+
+        // Returns whether the producer has to wait for the consumer to make space in the buffer.
+        bool push(bool final) noexcept {
+            std::unique_lock lk(m_buffer->m_mutex);
+            auto& items = m_buffer->m_items;
+            assert(m_buffer->m_size < items.size());
+            items[(m_buffer->m_front + m_buffer->m_size) % items.size()] = std::move(m_result);
+            ++m_buffer->m_size;
+            m_buffer->m_finished = final;
+            const auto waiting = !final && m_buffer->m_size == items.size();
+            m_buffer->m_producer_waiting = waiting;
+            const auto consumer = std::exchange(m_buffer->m_consumer, nullptr);
+            lk.unlock();
+            if (consumer) {
+                consumer->resume();
+            }
+            return waiting;
+        }
+
+        // Returns false if the buffer is empty, in which case the consumer, if any, is resumed
+        // once the producer has pushed the next item.
+        bool pop(result_type& result, resumable_promise* consumer) noexcept {
+            std::unique_lock lk(m_buffer->m_mutex);
+            if (m_buffer->m_size == 0) {
+                if (m_buffer->m_finished) {
+                    result = std::optional<wrapper_type<T>>();
+                    return true;
+                }
+                m_buffer->m_consumer = consumer;
+                return false;
+            }
+            auto& items = m_buffer->m_items;
+            result = std::move(items[m_buffer->m_front]);
+            m_buffer->m_front = (m_buffer->m_front + 1) % items.size();
+            --m_buffer->m_size;
+            const auto producer_waiting = std::exchange(m_buffer->m_producer_waiting, false);
+            lk.unlock();
+            if (producer_waiting) {
+                resume();
+            }
+            return true;
+        }
+
+        bool remove_consumer() noexcept {
+            std::lock_guard lk(m_buffer->m_mutex);
+            return std::exchange(m_buffer->m_consumer, nullptr) != nullptr;
+        }
+
     private:
         rc_ptr<promise> m_self;
         std::atomic_flag m_started;
         std::optional<event<std::optional<wrapper_type<T>>>> m_event;
-        task_result<std::optional<wrapper_type<T>>> m_result;
+        std::unique_ptr<buffer> m_buffer;
+        result_type m_result;
     };
 
 
@@ -150,35 +252,119 @@ namespace impl_stream {
     struct awaitable {
         using base = typename event<std::optional<wrapper_type<T>>>::awaitable;
 
-        base m_base;
+        std::optional<base> m_base;
         rc_ptr<promise<T, Alloc>> m_awaited = nullptr;
+        // Buffered streams hand over items without an event.
+        typename promise<T, Alloc>::result_type m_result;
+        impl_cancellation::stop_listener<awaitable> m_listener;
 
-        awaitable(base base, rc_ptr<promise<T, Alloc>> awaited) : m_base(base), m_awaited(awaited) {}
+        explicit awaitable(rc_ptr<promise<T, Alloc>> awaited) : m_awaited(std::move(awaited)) {}
 
-        bool await_ready() noexcept {
-            assert(m_awaited->has_event());
-            return m_base.await_ready();
+        // The stream is resumed in await_suspend so that it can inherit the stop token.
+        constexpr bool await_ready() const noexcept {
+            return false;
         }
 
         template <std::convertible_to<const resumable_promise&> Promise>
         bool await_suspend(std::coroutine_handle<Promise> enclosing) {
-            assert(m_awaited->has_event());
-            return m_base.await_suspend(enclosing);
+            auto token = impl_cancellation::get_stop_token(enclosing.promise());
+            if (m_awaited->buffered()) {
+                m_awaited->start(token);
+                if (!token.stop_possible()) {
+                    return !m_awaited->pop(m_result, &enclosing.promise());
+                }
+                const auto consumer = m_listener.intercept(enclosing.promise());
+                return !m_awaited->pop(m_result, consumer) && m_listener.listen(this, std::move(token));
+            }
+            m_base.emplace(m_awaited->await(std::move(token)));
+            // The consumer may stop waiting, the producer keeps running until it yields.
+            return m_base->await_suspend(enclosing);
         }
 
         item<T> await_resume() {
+            if (m_awaited->buffered()) {
+                if (m_listener.cancelled()) {
+                    throw operation_cancelled();
+                }
+                if (!m_result.has_value()) {
+                    [[maybe_unused]] const auto popped = m_awaited->pop(m_result, nullptr);
+                    assert(popped);
+                }
+                return { m_result.move_or_throw() };
+            }
+            assert(m_base);
             assert(m_awaited->has_event());
+            // The stream is not restarted while the producer is still running for a cancelled consumer.
+            auto result = m_base->await_resume();
             m_awaited->reset();
-            return { m_base.await_resume() };
+            return { std::move(result) };
+        }
+
+        bool try_cancel() noexcept {
+            return m_awaited->remove_consumer();
+        }
+    };
+
+
+    // An asynchronous iterator, incrementing it has to be awaited: `co_await ++it`.
+    template <class T, class Alloc>
+    class iterator {
+        struct increment_awaitable : awaitable<T, Alloc> {
+            iterator* m_iterator;
+
+            increment_awaitable(iterator* it) : awaitable<T, Alloc>(it->m_awaited), m_iterator(it) {}
+
+            iterator& await_resume() {
+                m_iterator->m_item.emplace(awaitable<T, Alloc>::await_resume());
+                return *m_iterator;
+            }
+        };
+
+    public:
+        using value_type = std::remove_cvref_t<T>;
+        using difference_type = ptrdiff_t;
+
+        iterator(rc_ptr<promise<T, Alloc>> awaited, item<T> item) : m_awaited(std::move(awaited)), m_item(std::move(item)) {}
+
+        T& operator*() const noexcept {
+            assert(m_item);
+            return **m_item;
+        }
+
+        std::remove_reference_t<T>* operator->() const noexcept {
+            assert(m_item);
+            return m_item->operator->();
+        }
+
+        increment_awaitable operator++() {
+            return { this };
+        }
+
+        bool operator==(std::default_sentinel_t) const noexcept {
+            return !m_item || !*m_item;
+        }
+
+    private:
+        rc_ptr<promise<T, Alloc>> m_awaited;
+        mutable std::optional<item<T>> m_item;
+    };
+
+
+    template <class T, class Alloc>
+    struct begin_awaitable : awaitable<T, Alloc> {
+        using awaitable<T, Alloc>::awaitable;
+
+        iterator<T, Alloc> await_resume() {
+            return { this->m_awaited, awaitable<T, Alloc>::await_resume() };
         }
     };
 
 
     template <class T, class Alloc>
-    auto promise<T, Alloc>::await() noexcept {
-        start();
+    auto promise<T, Alloc>::await(std::stop_token token) noexcept {
+        start(std::move(token));
         assert(m_event);
-        return awaitable<T, Alloc>(m_event->operator co_await(), rc_ptr(this));
+        return m_event->operator co_await();
     }
 
 } // namespace impl_stream
@@ -197,7 +383,18 @@ public:
     stream(rc_ptr<promise_type> promise) : m_promise(std::move(promise)) {}
 
     auto operator co_await() const {
-        return m_promise->await();
+        assert(valid());
+        return impl_stream::awaitable<T, Alloc>(m_promise);
+    }
+
+    // Awaits the first item: `for (auto it = co_await s.begin(); it != s.end(); co_await ++it)`.
+    auto begin() const {
+        assert(valid());
+        return impl_stream::begin_awaitable<T, Alloc>(m_promise);
+    }
+
+    std::default_sentinel_t end() const noexcept {
+        return {};
     }
 
     bool ready() const {
@@ -217,6 +414,19 @@ public:
         }
     }
 
+    // Must be called before the stream is started.
+    void set_stop_token(std::stop_token token) {
+        assert(valid());
+        m_promise->m_stop_token = std::move(token);
+    }
+
+    // Lets the stream run ahead of its consumer by up to `size` items, instead of producing
+    // each item only when it's awaited. Must be called before the stream is started.
+    void set_buffer_size(size_t size) {
+        assert(valid());
+        m_promise->set_buffer_size(size);
+    }
+
     bool valid() const {
         return !!m_promise;
     }
@@ -226,4 +436,39 @@ private:
 };
 
 
+// Streams of large datasets are best delivered in chunks, so that the consumer is resumed once per
+// chunk instead of once per element. A producer may yield spans of its own storage, such as a
+// `stream<std::span<const T>>`, but the span is only valid until the stream is awaited again,
+// and such a stream must not be buffered.
+//
+// `rechunk` groups the items of a per-element stream into chunks of `size` items, the last chunk
+// may be shorter. The source gets a read-ahead buffer of one chunk, so that it's not suspended for
+// every element either. Sources of references are not buffered, because they may reuse the referred
+// storage for the next item. The source must not have been started.
+template <class T, class Alloc>
+stream<std::vector<std::remove_cvref_t<T>>> rechunk(stream<T, Alloc> source, size_t size) {
+    assert(size > 0);
+    if constexpr (!std::is_reference_v<T>) {
+        source.set_buffer_size(size);
+    }
+    std::vector<std::remove_cvref_t<T>> chunk;
+    chunk.reserve(size);
+    while (auto item = co_await source) {
+        if constexpr (std::is_reference_v<T>) {
+            chunk.push_back(*item);
+        }
+        else {
+            chunk.push_back(std::move(*item));
+        }
+        if (chunk.size() == size) {
+            co_yield std::exchange(chunk, {});
+            chunk.reserve(size);
+        }
+    }
+    if (!chunk.empty()) {
+        co_yield std::move(chunk);
+    }
+}
+
+
 } // namespace asyncpp
\ No newline at end of file
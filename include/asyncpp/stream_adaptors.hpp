@@ -0,0 +1,381 @@
+#pragma once
+
+#include "channel.hpp"
+#include "scheduler.hpp"
+#include "stream.hpp"
+#include "task.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace asyncpp {
+
+namespace impl_stream {
+
+    // The stages of a pipeline are fused into a single step that maps each item of the source
+    // to at most one item of the output, and tells when the source need not be read further.
+    // The step runs in the frame of a single coroutine, regardless of the number of stages.
+    struct adaptor_tag {};
+
+
+    template <class Func>
+    struct transform_adaptor : adaptor_tag {
+        Func m_func;
+    };
+
+
+    template <class Pred>
+    struct filter_adaptor : adaptor_tag {
+        Pred m_pred;
+    };
+
+
+    struct take_adaptor : adaptor_tag {
+        size_t m_count;
+    };
+
+
+    template <class Adaptor>
+    concept adaptor = std::derived_from<std::remove_cvref_t<Adaptor>, adaptor_tag>;
+
+
+    struct identity_step {
+        template <class V>
+        std::optional<std::remove_cvref_t<V>> operator()(V&& value) const {
+            return std::forward<V>(value);
+        }
+
+        constexpr bool done() const noexcept {
+            return false;
+        }
+    };
+
+
+    template <class Step, class Func>
+    struct transform_step {
+        Step m_step;
+        Func m_func;
+
+        template <class V>
+        auto operator()(V&& value) {
+            auto result = m_step(std::forward<V>(value));
+            using output_type = std::remove_cvref_t<std::invoke_result_t<Func&, decltype(std::move(*result))>>;
+            if (!result) {
+                return std::optional<output_type>();
+            }
+            return std::optional<output_type>(std::invoke(m_func, std::move(*result)));
+        }
+
+        bool done() const noexcept {
+            return m_step.done();
+        }
+    };
+
+
+    template <class Step, class Pred>
+    struct filter_step {
+        Step m_step;
+        Pred m_pred;
+
+        template <class V>
+        auto operator()(V&& value) {
+            auto result = m_step(std::forward<V>(value));
+            if (result && !std::invoke(m_pred, std::as_const(*result))) {
+                result.reset();
+            }
+            return result;
+        }
+
+        bool done() const noexcept {
+            return m_step.done();
+        }
+    };
+
+
+    template <class Step>
+    struct take_step {
+        Step m_step;
+        size_t m_count;
+        size_t m_taken = 0;
+
+        template <class V>
+        auto operator()(V&& value) {
+            auto result = m_step(std::forward<V>(value));
+            if (result) {
+                ++m_taken;
+            }
+            return result;
+        }
+
+        bool done() const noexcept {
+            return m_taken == m_count || m_step.done();
+        }
+    };
+
+
+    // The step is checked before each item, so that the source isn't read at all when nothing is taken.
+    template <class Output, class T, class Alloc, class Step>
+    stream<Output> fuse(stream<T, Alloc> source, Step step) {
+        while (!step.done()) {
+            auto item = co_await source;
+            if (!item) {
+                break;
+            }
+            auto result = step(static_cast<T&&>(*item));
+            if (result) {
+                co_yield std::move(*result);
+            }
+        }
+    }
+
+
+    // A source stream with stages applied to it. It does not create a coroutine until it's
+    // converted to a stream, so stacking stages costs nothing.
+    template <class T, class Alloc, class Step>
+    class [[nodiscard]] pipeline {
+    public:
+        using value_type = typename std::invoke_result_t<Step&, T&&>::value_type;
+
+        pipeline(stream<T, Alloc> source, Step step) : m_source(std::move(source)), m_step(std::move(step)) {}
+
+        operator stream<value_type>() && {
+            return fuse<value_type>(std::move(m_source), std::move(m_step));
+        }
+
+        template <class Func>
+        friend auto operator|(pipeline&& lhs, transform_adaptor<Func> rhs) {
+            using step_type = transform_step<Step, Func>;
+            return pipeline<T, Alloc, step_type>(std::move(lhs.m_source), step_type{ std::move(lhs.m_step), std::move(rhs.m_func) });
+        }
+
+        template <class Pred>
+        friend auto operator|(pipeline&& lhs, filter_adaptor<Pred> rhs) {
+            using step_type = filter_step<Step, Pred>;
+            return pipeline<T, Alloc, step_type>(std::move(lhs.m_source), step_type{ std::move(lhs.m_step), std::move(rhs.m_pred) });
+        }
+
+        friend auto operator|(pipeline&& lhs, take_adaptor rhs) {
+            using step_type = take_step<Step>;
+            return pipeline<T, Alloc, step_type>(std::move(lhs.m_source), step_type{ std::move(lhs.m_step), rhs.m_count });
+        }
+
+    private:
+        stream<T, Alloc> m_source;
+        Step m_step;
+    };
+
+
+    template <class U>
+    struct merge_state {
+        using result_type = task_result<std::optional<U>>;
+
+        explicit merge_state(size_t num_sources) : m_channel(num_sources) {}
+
+        channel<result_type> m_channel;
+        std::stop_source m_stop_source;
+    };
+
+
+    // Forwards the items of a source to the merged stream. An empty item marks the end of the source.
+    template <class U, class T, class Alloc>
+    task<void> pump(stream<T, Alloc> source, std::shared_ptr<merge_state<U>> state) {
+        using result_type = typename merge_state<U>::result_type;
+        std::exception_ptr exception;
+        try {
+            while (auto item = co_await source) {
+                co_await state->m_channel.send(result_type(std::optional<U>(static_cast<T&&>(*item))));
+            }
+        }
+        catch (...) {
+            exception = std::current_exception();
+        }
+        if (exception) {
+            co_await state->m_channel.send(result_type(std::move(exception)));
+        }
+        else {
+            co_await state->m_channel.send(result_type(std::optional<U>()));
+        }
+    }
+
+
+    template <class R, class Func, class V>
+    task<R> map_item(std::shared_ptr<Func> func, V value) {
+        co_return std::invoke(*func, std::move(value));
+    }
+
+
+    template <class R, class Func, class V>
+    task<void> map_item_to(std::shared_ptr<Func> func, V value, std::shared_ptr<channel<task_result<R>>> results) {
+        task_result<R> result;
+        try {
+            result = std::invoke(*func, std::move(value));
+        }
+        catch (...) {
+            result = std::current_exception();
+        }
+        // The channel has space for all items in flight, so this never waits.
+        [[maybe_unused]] const auto sent = results->try_send(std::move(result));
+        assert(sent);
+        co_return;
+    }
+
+
+    struct stop_on_exit {
+        std::stop_source& m_stop_source;
+
+        ~stop_on_exit() {
+            m_stop_source.request_stop();
+        }
+    };
+
+} // namespace impl_stream
+
+
+// Applies `func` to each item of the stream.
+template <class Func>
+auto transform(Func func) {
+    return impl_stream::transform_adaptor<Func>{ {}, std::move(func) };
+}
+
+
+// Keeps only the items of the stream for which `pred` returns true.
+template <class Pred>
+auto filter(Pred pred) {
+    return impl_stream::filter_adaptor<Pred>{ {}, std::move(pred) };
+}
+
+
+// Keeps only the first `count` items of the stream.
+inline auto take(size_t count) {
+    return impl_stream::take_adaptor{ {}, count };
+}
+
+
+// Starts a pipeline of stages, which can be converted to a stream: `stream<int> s = source | take(3);`.
+template <class T, class Alloc, impl_stream::adaptor Adaptor>
+auto operator|(stream<T, Alloc> source, Adaptor&& adaptor) {
+    return impl_stream::pipeline<T, Alloc, impl_stream::identity_step>(std::move(source), {}) | std::forward<Adaptor>(adaptor);
+}
+
+
+// Yields the items of all the sources in the order they become available. Each source is
+// drained by a task of its own. If a source throws, the merged stream rethrows the exception,
+// and the rest of the sources are requested to stop. The same happens when the merged stream is
+// destroyed, and the tasks stop waiting even for sources that don't respond to the request.
+template <class T, class... Allocs>
+stream<std::remove_cvref_t<T>> merge(stream<T, Allocs>... sources) {
+    using value_type = std::remove_cvref_t<T>;
+    using state_type = impl_stream::merge_state<value_type>;
+
+    const auto state = std::make_shared<state_type>(sizeof...(sources));
+    impl_stream::stop_on_exit stop_pumps{ state->m_stop_source };
+    std::array<task<void>, sizeof...(sources)> pumps = { impl_stream::pump<value_type>(std::move(sources), state)... };
+    for (auto& pump : pumps) {
+        pump.set_stop_token(state->m_stop_source.get_token());
+        pump.launch();
+    }
+
+    size_t num_running = pumps.size();
+    while (num_running != 0) {
+        auto result = co_await state->m_channel.receive();
+        assert(result);
+        auto value = result->move_or_throw();
+        if (value) {
+            co_yield std::move(*value);
+        }
+        else {
+            --num_running;
+        }
+    }
+}
+
+
+// Applies `func` to the items of the stream on `sched`, with at most `max_inflight` items being
+// processed at a time. The results are yielded in the order of the source items. The function
+// is shared between the items, and it's called concurrently.
+template <class T, class Alloc, class Func>
+auto parallel_map(stream<T, Alloc> source, Func func, scheduler& sched, size_t max_inflight)
+    -> stream<std::remove_cvref_t<std::invoke_result_t<Func&, std::remove_cvref_t<T>&&>>> {
+    using value_type = std::remove_cvref_t<T>;
+    using result_type = std::remove_cvref_t<std::invoke_result_t<Func&, value_type&&>>;
+    assert(max_inflight > 0);
+
+    const auto shared_func = std::make_shared<Func>(std::move(func));
+    std::deque<task<result_type>> inflight;
+    bool exhausted = false;
+    while (true) {
+        while (!exhausted && inflight.size() < max_inflight) {
+            auto item = co_await source;
+            if (!item) {
+                exhausted = true;
+                break;
+            }
+            inflight.push_back(launch(impl_stream::map_item<result_type>(shared_func, value_type(static_cast<T&&>(*item))), sched));
+        }
+        if (inflight.empty()) {
+            break;
+        }
+        auto result = co_await inflight.front();
+        inflight.pop_front();
+        co_yield std::move(result);
+    }
+}
+
+
+// Like `parallel_map`, but yields the results in the order they are completed.
+template <class T, class Alloc, class Func>
+auto parallel_map_unordered(stream<T, Alloc> source, Func func, scheduler& sched, size_t max_inflight)
+    -> stream<std::remove_cvref_t<std::invoke_result_t<Func&, std::remove_cvref_t<T>&&>>> {
+    using value_type = std::remove_cvref_t<T>;
+    using result_type = std::remove_cvref_t<std::invoke_result_t<Func&, value_type&&>>;
+    assert(max_inflight > 0);
+
+    const auto shared_func = std::make_shared<Func>(std::move(func));
+    const auto results = std::make_shared<channel<task_result<result_type>>>(max_inflight);
+    // The results arrive through the channel, the tasks are kept to be awaited when they're done.
+    std::vector<task<void>> running;
+    size_t num_inflight = 0;
+    bool exhausted = false;
+    while (true) {
+        while (!exhausted && num_inflight < max_inflight) {
+            auto item = co_await source;
+            if (!item) {
+                exhausted = true;
+                break;
+            }
+            running.push_back(launch(impl_stream::map_item_to<result_type>(shared_func, value_type(static_cast<T&&>(*item)), results), sched));
+            ++num_inflight;
+        }
+        if (num_inflight == 0) {
+            break;
+        }
+        auto result = co_await results->receive();
+        --num_inflight;
+        for (auto it = running.begin(); it != running.end();) {
+            if (it->ready()) {
+                co_await *it;
+                it = running.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        co_yield result->move_or_throw();
+    }
+    for (auto& task : running) {
+        co_await task;
+    }
+}
+
+} // namespace asyncpp
\ No newline at end of file
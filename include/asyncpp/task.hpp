@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cancellation.hpp"
 #include "event.hpp"
 #include "memory/rc_ptr.hpp"
 #include "promise.hpp"
@@ -8,6 +9,7 @@
 
 #include <cassert>
 #include <fstream>
+#include <stop_token>
 
 
 namespace asyncpp {
@@ -16,7 +18,7 @@ namespace asyncpp {
 namespace impl_task {
 
     template <class T, class Alloc, class Task, class Event>
-    struct promise : result_promise<T>, resumable_promise, schedulable_promise, rc_from_this, allocator_aware_promise<Alloc> {
+    struct promise : result_promise<T>, resumable_promise, schedulable_promise, stoppable_promise, rc_from_this, allocator_aware_promise<Alloc> {
         struct final_awaitable {
             constexpr bool await_ready() const noexcept { return false; }
             void await_suspend(std::coroutine_handle<promise> handle) const noexcept {
@@ -49,8 +51,12 @@ namespace impl_task {
             return m_scheduler ? m_scheduler->schedule(*this) : resume_now();
         }
 
-        void start() {
+        // The task inherits the stop token of the coroutine that starts it, unless it has its own.
+        void start(std::stop_token token = {}) {
             if (!INTERLEAVED(m_started.test_and_set(std::memory_order_relaxed))) {
+                if (!m_stop_token.stop_possible()) {
+                    m_stop_token = std::move(token);
+                }
                 m_self.reset(this);
                 resume();
             }
@@ -81,12 +87,23 @@ namespace impl_task {
             : Event::awaitable(std::move(base)), m_awaited(awaited) {
             assert(m_awaited);
         }
+
+        // The task is started only once it's awaited so that it can inherit the stop token.
+        // A stop request does not cut the wait short, the task completes as it sees fit.
+        template <std::convertible_to<const resumable_promise&> Enclosing>
+        bool await_suspend(std::coroutine_handle<Enclosing> enclosing) {
+            return await_suspend(static_cast<resumable_promise&>(enclosing.promise()), impl_cancellation::get_stop_token(enclosing.promise()));
+        }
+
+        bool await_suspend(resumable_promise& enclosing, std::stop_token token = {}) {
+            m_awaited->start(std::move(token));
+            return Event::awaitable::await_suspend(enclosing);
+        }
     };
 
     template <class T, class Alloc, class Task, class Event>
     auto promise<T, Alloc, Task, Event>::await(rc_ptr<promise> pr) {
         assert(pr);
-        pr->start();
         auto base = pr->m_event.operator co_await();
         return awaitable<T, promise, Event>{ std::move(base), std::move(pr) };
     }
@@ -128,6 +145,12 @@ public:
         }
     }
 
+    // Must be called before the task is started.
+    void set_stop_token(std::stop_token token) {
+        assert(valid());
+        m_promise->m_stop_token = std::move(token);
+    }
+
     auto operator co_await() {
         assert(valid());
         return promise_type::await(std::move(m_promise));
@@ -167,6 +190,12 @@ public:
         }
     }
 
+    // Must be called before the task is started.
+    void set_stop_token(std::stop_token token) {
+        assert(valid());
+        m_promise->m_stop_token = std::move(token);
+    }
+
     auto operator co_await() {
         assert(valid());
         return promise_type::await(m_promise);
@@ -4,6 +4,7 @@
 #include "container/atomic_deque.hpp"
 #include "container/atomic_stack.hpp"
 #include "scheduler.hpp"
+#include "sleep.hpp"
 #include "threading/cache.hpp"
 #include "threading/spinlock.hpp"
 
@@ -36,6 +37,7 @@ public:
 
     private:
         void run(pack& pack);
+        void park();
 
     public:
         worker* m_next = nullptr;
@@ -45,6 +47,7 @@ public:
         alignas(avoid_false_sharing) queue m_promises;
         alignas(avoid_false_sharing) std::atomic_flag m_blocked;
         alignas(avoid_false_sharing) std::binary_semaphore m_sema;
+        impl_sleep::timer_queue::handle m_timers = impl_sleep::timer_queue::create();
         alignas(avoid_false_sharing) std::jthread m_thread;
         alignas(avoid_false_sharing) std::atomic_flag m_cancelled;
     };
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "container/atomic_collection.hpp"
+#include "promise.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+
+
+namespace asyncpp {
+
+// Waits for a group of operations to finish, like Go's `sync.WaitGroup`. Each operation
+// is added to the group before it's started, and it calls `done` when it has finished.
+//
+// Unlike a latch, the group can be reused once it's empty. As in Go, adding to an empty group
+// must happen before the coroutines start waiting, and not while they are still being resumed
+// from the previous wait.
+class wait_group {
+    struct awaitable {
+        wait_group* m_owner = nullptr;
+        resumable_promise* m_enclosing = nullptr;
+        awaitable* m_next = nullptr;
+
+        bool await_ready() const noexcept;
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> promise) noexcept {
+            assert(m_owner);
+            m_enclosing = &promise.promise();
+            const auto status = m_owner->m_awaiters.push(this);
+            return !m_owner->m_awaiters.closed(status);
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+public:
+    wait_group() noexcept;
+    wait_group(wait_group&&) = delete;
+    wait_group& operator=(wait_group&&) = delete;
+    ~wait_group();
+
+    void add(ptrdiff_t n = 1) noexcept;
+    void done() noexcept;
+    awaitable wait() noexcept;
+    awaitable operator co_await() noexcept;
+
+    ptrdiff_t _debug_get_counter() const noexcept;
+
+private:
+    std::atomic<ptrdiff_t> m_counter = 0;
+    // Closed while the group is empty.
+    atomic_collection<awaitable, &awaitable::m_next> m_awaiters;
+};
+
+} // namespace asyncpp
\ No newline at end of file
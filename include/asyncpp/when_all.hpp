@@ -0,0 +1,235 @@
+#pragma once
+
+#include "cancellation.hpp"
+#include "concepts.hpp"
+#include "promise.hpp"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <coroutine>
+#include <ranges>
+#include <stop_token>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+
+namespace asyncpp {
+
+namespace impl_when_all {
+
+    // clang-format off
+    template <class Task>
+    concept fan_in_task = requires(std::remove_reference_t<Task>& t, resumable_promise& promise) {
+        { t.operator co_await().await_ready() } -> std::convertible_to<bool>;
+        { t.operator co_await().await_suspend(promise) } -> std::convertible_to<bool>;
+        { t.operator co_await().await_resume() };
+    };
+    // clang-format on
+
+    template <class Task>
+    using awaitable_t = decltype(std::declval<std::remove_reference_t<Task>&>().operator co_await());
+
+    template <class Task>
+    using result_t = typename task_result<await_result_t<std::remove_reference_t<Task>>>::value_type;
+
+
+    template <class Awaitable>
+    auto take_result(Awaitable& awaitable) {
+        using T = decltype(awaitable.await_resume());
+        if constexpr (std::is_void_v<T>) {
+            awaitable.await_resume();
+            return typename task_result<T>::value_type{};
+        }
+        else {
+            return typename task_result<T>::value_type(awaitable.await_resume());
+        }
+    }
+
+
+    struct fan_in {
+        // The awaiting coroutine holds one extra count until it has suspended.
+        explicit fan_in(size_t count) noexcept : m_remaining(count + 1) {}
+
+        bool arrive() noexcept {
+            return 1 == m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        std::atomic_size_t m_remaining;
+        resumable_promise* m_enclosing = nullptr;
+    };
+
+
+    struct waiter : resumable_promise {
+        fan_in* m_fan_in = nullptr;
+
+        void resume() override {
+            assert(m_fan_in);
+            if (m_fan_in->arrive()) {
+                assert(m_fan_in->m_enclosing);
+                m_fan_in->m_enclosing->resume();
+            }
+        }
+    };
+
+
+    // Tasks inherit the stop token through the waiter, other awaitables don't take one.
+    template <class Awaitable>
+    bool suspend_on(Awaitable& awaitable, resumable_promise& waiting, const std::stop_token& token) {
+        if constexpr (requires { awaitable.await_suspend(waiting, token); }) {
+            return awaitable.await_suspend(waiting, token);
+        }
+        else {
+            return awaitable.await_suspend(waiting);
+        }
+    }
+
+
+    template <class Awaitable>
+    void add_awaiting(Awaitable& awaitable, waiter& waiting, fan_in& counter, const std::stop_token& token) {
+        waiting.m_fan_in = &counter;
+        if (awaitable.await_ready() || !suspend_on(awaitable, waiting, token)) {
+            [[maybe_unused]] const auto last = counter.arrive(); // The awaiter still holds a count.
+            assert(!last);
+        }
+    }
+
+
+    template <class... Tasks>
+    class tuple_awaitable {
+    public:
+        explicit tuple_awaitable(std::tuple<awaitable_t<Tasks>...> awaitables) : m_awaitables(std::move(awaitables)) {}
+        tuple_awaitable(const tuple_awaitable&) = delete;
+        tuple_awaitable& operator=(const tuple_awaitable&) = delete;
+
+        constexpr bool await_ready() const noexcept {
+            return sizeof...(Tasks) == 0;
+        }
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> enclosing) {
+            m_fan_in.m_enclosing = &enclosing.promise();
+            const auto token = impl_cancellation::get_stop_token(enclosing.promise());
+            [this, &token]<size_t... Indices>(std::index_sequence<Indices...>) {
+                (..., add_awaiting(std::get<Indices>(m_awaitables), m_waiters[Indices], m_fan_in, token));
+            }(std::index_sequence_for<Tasks...>{});
+            return !m_fan_in.arrive();
+        }
+
+        std::tuple<result_t<Tasks>...> await_resume() {
+            return [this]<size_t... Indices>(std::index_sequence<Indices...>) {
+                return std::tuple<result_t<Tasks>...>{ take_result(std::get<Indices>(m_awaitables))... };
+            }(std::index_sequence_for<Tasks...>{});
+        }
+
+    private:
+        std::tuple<awaitable_t<Tasks>...> m_awaitables;
+        std::array<waiter, sizeof...(Tasks)> m_waiters;
+        fan_in m_fan_in{ sizeof...(Tasks) };
+    };
+
+
+    template <class Task>
+    struct child {
+        awaitable_t<Task> m_awaitable;
+        waiter m_waiter;
+    };
+
+
+    template <class Task>
+    class range_awaitable {
+    public:
+        explicit range_awaitable(std::vector<child<Task>> children) : m_children(std::move(children)), m_fan_in(m_children.size()) {}
+        range_awaitable(const range_awaitable&) = delete;
+        range_awaitable& operator=(const range_awaitable&) = delete;
+
+        bool await_ready() const noexcept {
+            return m_children.empty();
+        }
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> enclosing) {
+            m_fan_in.m_enclosing = &enclosing.promise();
+            const auto token = impl_cancellation::get_stop_token(enclosing.promise());
+            for (auto& child : m_children) {
+                add_awaiting(child.m_awaitable, child.m_waiter, m_fan_in, token);
+            }
+            return !m_fan_in.arrive();
+        }
+
+        std::vector<result_t<Task>> await_resume() {
+            std::vector<result_t<Task>> results;
+            results.reserve(m_children.size());
+            for (auto& child : m_children) {
+                results.push_back(take_result(child.m_awaitable));
+            }
+            return results;
+        }
+
+    private:
+        std::vector<child<Task>> m_children;
+        fan_in m_fan_in;
+    };
+
+
+    // The awaitables above must stay in place once suspended, but the operations that
+    // create them are freely movable until they are awaited.
+    template <class... Tasks>
+    class [[nodiscard]] tuple_operation {
+    public:
+        explicit tuple_operation(awaitable_t<Tasks>... awaitables) : m_awaitables(std::move(awaitables)...) {}
+
+        auto operator co_await() {
+            return tuple_awaitable<Tasks...>(std::move(m_awaitables));
+        }
+
+    private:
+        std::tuple<awaitable_t<Tasks>...> m_awaitables;
+    };
+
+
+    template <class Task>
+    class [[nodiscard]] range_operation {
+    public:
+        template <std::ranges::input_range Range>
+        explicit range_operation(Range&& tasks) {
+            if constexpr (std::ranges::sized_range<Range>) {
+                m_children.reserve(std::ranges::size(tasks));
+            }
+            for (auto&& task : tasks) {
+                m_children.push_back(child<Task>{ task.operator co_await(), {} });
+            }
+        }
+
+        auto operator co_await() {
+            return range_awaitable<Task>(std::move(m_children));
+        }
+
+    private:
+        std::vector<child<Task>> m_children;
+    };
+
+} // namespace impl_when_all
+
+
+// Launches all tasks and resumes the awaiting coroutine once all of them have completed.
+// The results are returned in a tuple, `void` results are represented by `nullptr`. If any
+// of the tasks throws, the exception of the first one in argument order is rethrown. The
+// tasks inherit the stop token of the awaiting coroutine.
+template <impl_when_all::fan_in_task... Tasks>
+auto when_all(Tasks&&... tasks) {
+    return impl_when_all::tuple_operation<std::remove_cvref_t<Tasks>...>(tasks.operator co_await()...);
+}
+
+
+// Launches all tasks in the range and resumes the awaiting coroutine once all of them have
+// completed. The results are returned in a vector in the order of the range.
+template <std::ranges::input_range Range>
+    requires impl_when_all::fan_in_task<std::ranges::range_reference_t<Range>>
+auto when_all(Range&& tasks) {
+    return impl_when_all::range_operation<std::remove_cvref_t<std::ranges::range_reference_t<Range>>>(std::forward<Range>(tasks));
+}
+
+} // namespace asyncpp
\ No newline at end of file
@@ -0,0 +1,307 @@
+#pragma once
+
+#include "promise.hpp"
+#include "when_all.hpp"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <coroutine>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <stop_token>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+namespace asyncpp {
+
+namespace impl_when_any {
+
+    using impl_when_all::awaitable_t;
+    using impl_when_all::result_t;
+    using impl_when_all::suspend_on;
+    using impl_when_all::take_result;
+
+
+    // The tasks that lose the race are still running when the awaiting coroutine resumes,
+    // so the state they report to is allocated separately, and destroyed by the last one.
+    struct fan_in {
+        static constexpr size_t no_winner = std::numeric_limits<size_t>::max();
+
+        struct forward_stop {
+            std::stop_source m_source;
+            void operator()() noexcept {
+                auto source = m_source; // Stopping the tasks may destroy this callback.
+                source.request_stop();
+            }
+        };
+
+        virtual ~fan_in() = default;
+
+        void arrive(size_t index) noexcept {
+            size_t expected = no_winner;
+            if (m_winner.compare_exchange_strong(expected, index, std::memory_order_acq_rel)) {
+                // The rest of the tasks are no longer needed.
+                m_stop_source.request_stop();
+                if (1 == m_pending.fetch_sub(1, std::memory_order_acq_rel)) {
+                    assert(m_enclosing);
+                    m_enclosing->resume();
+                }
+            }
+            release();
+        }
+
+        void acquire() noexcept {
+            m_references.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void release() noexcept {
+            if (1 == m_references.fetch_sub(1, std::memory_order_acq_rel)) {
+                delete this;
+            }
+        }
+
+        bool decided() const noexcept {
+            return m_winner.load(std::memory_order_acquire) != no_winner;
+        }
+
+        void listen(std::stop_token token) {
+            if (token.stop_possible()) {
+                m_parent_stop.emplace(std::move(token), forward_stop{ m_stop_source });
+            }
+        }
+
+        // One count for the winner, one for the awaiter until it has suspended.
+        std::atomic_size_t m_pending = 2;
+        std::atomic_size_t m_references = 1;
+        std::atomic_size_t m_winner = no_winner;
+        resumable_promise* m_enclosing = nullptr;
+        std::stop_source m_stop_source;
+        std::optional<std::stop_callback<forward_stop>> m_parent_stop;
+    };
+
+
+    struct waiter : resumable_promise {
+        fan_in* m_fan_in = nullptr;
+        size_t m_index = 0;
+
+        void resume() override {
+            assert(m_fan_in);
+            m_fan_in->arrive(m_index);
+        }
+    };
+
+
+    template <class Awaitable>
+    void add_awaiting(Awaitable& awaitable, waiter& waiting, fan_in& state, size_t index) {
+        // Once there is a winner, the rest of the tasks are not started.
+        if (state.decided()) {
+            return;
+        }
+        state.acquire();
+        waiting.m_fan_in = &state;
+        waiting.m_index = index;
+        if (awaitable.await_ready() || !suspend_on(awaitable, waiting, state.m_stop_source.get_token())) {
+            state.arrive(index);
+        }
+    }
+
+
+    template <class... Tasks>
+    struct tuple_state : fan_in {
+        explicit tuple_state(awaitable_t<Tasks>... awaitables) : m_awaitables(std::move(awaitables)...) {}
+
+        std::tuple<awaitable_t<Tasks>...> m_awaitables;
+        std::array<waiter, sizeof...(Tasks)> m_waiters;
+    };
+
+
+    template <class Task>
+    struct range_state : fan_in {
+        struct child {
+            awaitable_t<Task> m_awaitable;
+            waiter m_waiter;
+        };
+
+        std::vector<child> m_children;
+    };
+
+
+    template <class State>
+    class basic_awaitable {
+    public:
+        explicit basic_awaitable(State* state) noexcept : m_state(state) {
+            assert(m_state);
+        }
+        basic_awaitable(const basic_awaitable&) = delete;
+        basic_awaitable& operator=(const basic_awaitable&) = delete;
+        ~basic_awaitable() {
+            m_state->release();
+        }
+
+        constexpr bool await_ready() const noexcept {
+            return false;
+        }
+
+    protected:
+        bool suspend(resumable_promise& enclosing) {
+            m_state->m_enclosing = &enclosing;
+            return 1 != m_state->m_pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        size_t winner() const noexcept {
+            const auto index = m_state->m_winner.load(std::memory_order_acquire);
+            assert(index != fan_in::no_winner);
+            return index;
+        }
+
+    protected:
+        State* m_state;
+    };
+
+
+    template <class... Tasks>
+    class tuple_awaitable : public basic_awaitable<tuple_state<Tasks...>> {
+        using state_t = tuple_state<Tasks...>;
+        using result_type = std::variant<result_t<Tasks>...>;
+
+    public:
+        using basic_awaitable<state_t>::basic_awaitable;
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> enclosing) {
+            auto& state = *this->m_state;
+            state.listen(impl_cancellation::get_stop_token(enclosing.promise()));
+            [&state]<size_t... Indices>(std::index_sequence<Indices...>) {
+                (..., add_awaiting(std::get<Indices>(state.m_awaitables), state.m_waiters[Indices], state, Indices));
+            }(std::index_sequence_for<Tasks...>{});
+            return this->suspend(enclosing.promise());
+        }
+
+        result_type await_resume() {
+            static constexpr auto take = []<size_t... Indices>(std::index_sequence<Indices...>) {
+                return std::array<result_type (*)(state_t&), sizeof...(Tasks)>{
+                    [](state_t& state) {
+                        return result_type(std::in_place_index<Indices>, take_result(std::get<Indices>(state.m_awaitables)));
+                    }...
+                };
+            }(std::index_sequence_for<Tasks...>{});
+            return take[this->winner()](*this->m_state);
+        }
+    };
+
+
+    template <class Task>
+    class range_awaitable : public basic_awaitable<range_state<Task>> {
+        using state_t = range_state<Task>;
+
+    public:
+        using basic_awaitable<state_t>::basic_awaitable;
+
+        template <std::convertible_to<const resumable_promise&> Promise>
+        bool await_suspend(std::coroutine_handle<Promise> enclosing) {
+            auto& state = *this->m_state;
+            state.listen(impl_cancellation::get_stop_token(enclosing.promise()));
+            for (size_t index = 0; index < state.m_children.size(); ++index) {
+                add_awaiting(state.m_children[index].m_awaitable, state.m_children[index].m_waiter, state, index);
+            }
+            return this->suspend(enclosing.promise());
+        }
+
+        std::pair<size_t, result_t<Task>> await_resume() {
+            const auto index = this->winner();
+            return { index, take_result(this->m_state->m_children[index].m_awaitable) };
+        }
+    };
+
+
+    // Owns the state until it's handed over to the awaitable by co_await.
+    template <class State, class Awaitable>
+    class [[nodiscard]] basic_operation {
+    public:
+        basic_operation(basic_operation&& rhs) noexcept : m_state(std::exchange(rhs.m_state, nullptr)) {}
+        basic_operation& operator=(basic_operation&& rhs) noexcept {
+            release();
+            m_state = std::exchange(rhs.m_state, nullptr);
+            return *this;
+        }
+        ~basic_operation() {
+            release();
+        }
+
+        Awaitable operator co_await() {
+            assert(m_state);
+            return Awaitable(std::exchange(m_state, nullptr));
+        }
+
+    protected:
+        explicit basic_operation(State* state) noexcept : m_state(state) {}
+
+    private:
+        void release() {
+            if (m_state) {
+                m_state->release();
+            }
+        }
+
+    protected:
+        State* m_state = nullptr;
+    };
+
+
+    template <class... Tasks>
+    class tuple_operation : public basic_operation<tuple_state<Tasks...>, tuple_awaitable<Tasks...>> {
+        using state_t = tuple_state<Tasks...>;
+
+    public:
+        explicit tuple_operation(awaitable_t<Tasks>... awaitables)
+            : basic_operation<state_t, tuple_awaitable<Tasks...>>(new state_t(std::move(awaitables)...)) {}
+    };
+
+
+    template <class Task>
+    class range_operation : public basic_operation<range_state<Task>, range_awaitable<Task>> {
+        using state_t = range_state<Task>;
+
+    public:
+        template <std::ranges::input_range Range>
+        explicit range_operation(Range&& tasks) : basic_operation<state_t, range_awaitable<Task>>(new state_t()) {
+            auto& children = this->m_state->m_children;
+            if constexpr (std::ranges::sized_range<Range>) {
+                children.reserve(std::ranges::size(tasks));
+            }
+            for (auto&& task : tasks) {
+                children.push_back(typename state_t::child{ task.operator co_await(), {} });
+            }
+            assert(!children.empty() && "when_any requires at least one task");
+        }
+    };
+
+} // namespace impl_when_any
+
+
+// Launches all tasks and resumes the awaiting coroutine as soon as the first one completes.
+// The result of the first task is returned in a variant, whose index identifies the task.
+// Stop is requested on the rest of the tasks, and their results are discarded. Tasks that
+// have not been started by the time the first one completes are not started at all.
+template <impl_when_all::fan_in_task... Tasks>
+    requires(sizeof...(Tasks) > 0)
+auto when_any(Tasks&&... tasks) {
+    return impl_when_any::tuple_operation<std::remove_cvref_t<Tasks>...>(tasks.operator co_await()...);
+}
+
+
+// Launches all tasks in the range and resumes the awaiting coroutine as soon as the first
+// one completes. The index of the first task is returned along with its result. The rest
+// of the tasks are stopped the same way as above.
+template <std::ranges::input_range Range>
+    requires impl_when_all::fan_in_task<std::ranges::range_reference_t<Range>>
+auto when_any(Range&& tasks) {
+    return impl_when_any::range_operation<std::remove_cvref_t<std::ranges::range_reference_t<Range>>>(std::forward<Range>(tasks));
+}
+
+} // namespace asyncpp
\ No newline at end of file
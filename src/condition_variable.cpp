@@ -0,0 +1,136 @@
+#include <asyncpp/condition_variable.hpp>
+
+#include <mutex>
+
+
+namespace asyncpp {
+
+void condition_variable::basic_awaitable::resume() {
+    // A satisfied predicate wins over a stop request, same as for `std::condition_variable_any`.
+    if (done()) {
+        m_cancelled = false;
+    }
+    // A stop request that came while the coroutine was notified cancels it only if it has to wait again.
+    else if (m_cancelled || !m_owner->add_awaiting(this)) {
+        m_cancelled = true;
+    }
+    else {
+        // The coroutine may be resumed before `unlock` returns.
+        m_mtx->unlock();
+        return;
+    }
+    m_callback.reset();
+    assert(m_enclosing);
+    m_enclosing->resume();
+}
+
+
+void condition_variable::basic_awaitable::wait(resumable_promise& enclosing, std::stop_token token) {
+    assert(m_owner);
+    assert(m_mtx);
+    m_enclosing = &enclosing;
+    m_relock.m_owner = m_mtx;
+    m_relock.m_enclosing = this;
+    m_owner->add_awaiting(this);
+    if (token.stop_possible()) {
+        m_token = token;
+        m_callback.emplace(std::move(token), callback{ this });
+    }
+    // The coroutine may be resumed before `unlock` returns.
+    m_mtx->unlock();
+}
+
+
+void condition_variable::basic_awaitable::relock() {
+    if (m_mtx->add_awaiting(&m_relock)) {
+        resume();
+    }
+}
+
+
+void condition_variable::basic_awaitable::cancel() noexcept {
+    if (m_owner->remove_awaiting(this)) {
+        m_cancelled = true;
+        relock();
+    }
+}
+
+
+void condition_variable::basic_awaitable::await_resume() const {
+    if (m_cancelled) {
+        throw operation_cancelled();
+    }
+}
+
+
+condition_variable::~condition_variable() {
+    std::lock_guard lk(m_spinlock);
+    // Nothing may be waiting when the condition variable is destroyed.
+    if (!m_queue.empty()) {
+        std::terminate();
+    }
+}
+
+
+bool condition_variable::add_awaiting(basic_awaitable* waiting) {
+    std::lock_guard lk(m_spinlock);
+    // Checked under the lock, so a stop request either sees the coroutine queued or is seen here.
+    if (waiting->m_token.stop_requested()) {
+        return false;
+    }
+    waiting->m_queued = true;
+    m_queue.push_back(waiting);
+    return true;
+}
+
+
+bool condition_variable::remove_awaiting(basic_awaitable* waiting) noexcept {
+    std::lock_guard lk(m_spinlock);
+    if (waiting->m_queued) {
+        waiting->m_queued = false;
+        m_queue.erase(waiting);
+        return true;
+    }
+    return false;
+}
+
+
+condition_variable::awaitable<condition_variable::no_predicate> condition_variable::wait(unique_lock<mutex>& lk) noexcept {
+    assert(lk.owns_lock());
+    return { this, &lk.mutex(), no_predicate{} };
+}
+
+
+void condition_variable::notify_one() {
+    std::unique_lock lk(m_spinlock);
+    const auto waiting = m_queue.pop_front();
+    if (waiting) {
+        waiting->m_queued = false;
+        lk.unlock();
+        waiting->relock();
+    }
+}
+
+
+void condition_variable::notify_all() {
+    queue_type notified;
+    {
+        std::lock_guard lk(m_spinlock);
+        while (const auto waiting = m_queue.pop_front()) {
+            waiting->m_queued = false;
+            notified.push_back(waiting);
+        }
+    }
+    // At most one of them acquires the mutex here, the rest are queued on the mutex.
+    while (const auto waiting = notified.pop_front()) {
+        waiting->relock();
+    }
+}
+
+
+void condition_variable::_debug_clear() noexcept {
+    m_queue.~deque();
+    new (&m_queue) decltype(m_queue);
+}
+
+} // namespace asyncpp
\ No newline at end of file
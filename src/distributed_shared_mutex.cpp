@@ -0,0 +1,226 @@
+#include <asyncpp/distributed_shared_mutex.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+
+namespace asyncpp {
+
+bool distributed_shared_mutex::exclusive_awaitable::await_ready() const noexcept {
+    assert(m_owner);
+    return m_owner->try_lock();
+}
+
+
+bool distributed_shared_mutex::shared_awaitable::await_ready() const noexcept {
+    assert(m_owner);
+    return m_owner->try_lock_shared();
+}
+
+
+exclusively_locked_mutex<distributed_shared_mutex> distributed_shared_mutex::exclusive_awaitable::await_resume() const noexcept {
+    assert(m_owner);
+    return { m_owner };
+}
+
+
+shared_locked_mutex<distributed_shared_mutex> distributed_shared_mutex::shared_awaitable::await_resume() const noexcept {
+    assert(m_owner);
+    return { m_owner };
+}
+
+
+distributed_shared_mutex::distributed_shared_mutex(size_t num_slots)
+    : m_num_slots(num_slots != 0 ? num_slots : std::max(size_t(std::thread::hardware_concurrency()), size_t(1))) {
+    m_slots = std::make_unique<slot[]>(m_num_slots);
+}
+
+
+distributed_shared_mutex::~distributed_shared_mutex() {
+    std::lock_guard lk(m_spinlock);
+    // Mutex must be released before destroying.
+    if (m_exclusive || m_draining || count_readers() != 0 || !m_exclusive_queue.empty() || !m_shared_queue.empty()) {
+        std::terminate();
+    }
+}
+
+
+auto distributed_shared_mutex::local_slot() noexcept -> slot& {
+    static std::atomic_size_t num_threads = 0;
+    thread_local const size_t thread_index = num_threads.fetch_add(1, std::memory_order_relaxed);
+    return m_slots[thread_index % m_num_slots];
+}
+
+
+ptrdiff_t distributed_shared_mutex::count_readers() const noexcept {
+    ptrdiff_t count = 0;
+    for (size_t i = 0; i < m_num_slots; ++i) {
+        count += m_slots[i].m_readers.load();
+    }
+    return count;
+}
+
+
+bool distributed_shared_mutex::try_lock_shared_fast() noexcept {
+    // Either the reader sees the writer's flag, or the writer sees the reader in the slot.
+    auto& local = local_slot();
+    local.m_readers.fetch_add(1);
+    if (!m_writer_pending.load()) {
+        return true;
+    }
+    local.m_readers.fetch_sub(1);
+    check_drained();
+    return false;
+}
+
+
+void distributed_shared_mutex::check_drained() {
+    basic_awaitable* writer = nullptr;
+    {
+        std::lock_guard lk(m_spinlock);
+        if (m_draining && count_readers() == 0) {
+            writer = std::exchange(m_draining, nullptr);
+            m_exclusive = true;
+        }
+    }
+    if (writer) {
+        assert(writer->m_enclosing);
+        writer->m_enclosing->resume();
+    }
+}
+
+
+void distributed_shared_mutex::start_writer(basic_awaitable* writer, queue_type& unblocked) noexcept {
+    if (count_readers() == 0) {
+        m_exclusive = true;
+        unblocked.push_back(writer);
+    }
+    else {
+        m_draining = writer;
+    }
+}
+
+
+bool distributed_shared_mutex::try_lock() noexcept {
+    queue_type unblocked;
+    {
+        std::lock_guard lk(m_spinlock);
+        if (m_writer_pending.load()) {
+            return false;
+        }
+        m_writer_pending.store(true);
+        if (count_readers() == 0) {
+            m_exclusive = true;
+            return true;
+        }
+        m_writer_pending.store(false);
+        // Readers may have queued up while the flag was set.
+        ptrdiff_t num_unblocked = 0;
+        while (const auto reader = m_shared_queue.pop_front()) {
+            unblocked.push_back(reader);
+            ++num_unblocked;
+        }
+        local_slot().m_readers.fetch_add(num_unblocked);
+    }
+    while (const auto waiting = unblocked.pop_front()) {
+        assert(waiting->m_enclosing);
+        waiting->m_enclosing->resume();
+    }
+    return false;
+}
+
+
+bool distributed_shared_mutex::try_lock_shared() noexcept {
+    return try_lock_shared_fast();
+}
+
+
+distributed_shared_mutex::exclusive_awaitable distributed_shared_mutex::exclusive() noexcept {
+    return exclusive_awaitable{ this };
+}
+
+
+distributed_shared_mutex::shared_awaitable distributed_shared_mutex::shared() noexcept {
+    return shared_awaitable{ this };
+}
+
+
+bool distributed_shared_mutex::add_awaiting(basic_awaitable* waiting) {
+    if (waiting->m_type == awaitable_type::exclusive) {
+        std::lock_guard lk(m_spinlock);
+        if (m_writer_pending.load()) {
+            m_exclusive_queue.push_back(waiting);
+            return false;
+        }
+        m_writer_pending.store(true);
+        if (count_readers() == 0) {
+            m_exclusive = true;
+            return true;
+        }
+        m_draining = waiting;
+        return false;
+    }
+    else if (waiting->m_type == awaitable_type::shared) {
+        if (try_lock_shared_fast()) {
+            return true;
+        }
+        std::lock_guard lk(m_spinlock);
+        // The flag is only changed under the lock, so the writer is gone if it's clear.
+        if (!m_writer_pending.load()) {
+            local_slot().m_readers.fetch_add(1);
+            return true;
+        }
+        m_shared_queue.push_back(waiting);
+        return false;
+    }
+    assert(false && "improperly initialized awaiter");
+    return false;
+}
+
+
+void distributed_shared_mutex::unlock() {
+    queue_type unblocked;
+    {
+        std::lock_guard lk(m_spinlock);
+        assert(m_exclusive);
+        m_exclusive = false;
+        ptrdiff_t num_unblocked = 0;
+        while (const auto reader = m_shared_queue.pop_front()) {
+            unblocked.push_back(reader);
+            ++num_unblocked;
+        }
+        local_slot().m_readers.fetch_add(num_unblocked);
+        // The next writer waits for the readers that were queued behind this one.
+        if (const auto writer = m_exclusive_queue.pop_front()) {
+            start_writer(writer, unblocked);
+        }
+        else {
+            m_writer_pending.store(false);
+        }
+    }
+    while (const auto waiting = unblocked.pop_front()) {
+        assert(waiting->m_enclosing);
+        waiting->m_enclosing->resume();
+    }
+}
+
+
+void distributed_shared_mutex::unlock_shared() {
+    local_slot().m_readers.fetch_sub(1);
+    if (m_writer_pending.load()) {
+        check_drained();
+    }
+}
+
+
+bool distributed_shared_mutex::_debug_is_exclusive_locked() const noexcept {
+    return m_exclusive;
+}
+
+
+size_t distributed_shared_mutex::_debug_is_shared_locked() const noexcept {
+    return size_t(count_readers());
+}
+
+} // namespace asyncpp
\ No newline at end of file
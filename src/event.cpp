@@ -0,0 +1,169 @@
+#include <asyncpp/event.hpp>
+
+#include <mutex>
+
+
+namespace asyncpp {
+
+bool manual_reset_event::awaitable::await_ready() const noexcept {
+    assert(m_owner);
+    return m_owner->is_set();
+}
+
+
+manual_reset_event::manual_reset_event(bool is_set) noexcept {
+    if (is_set) {
+        m_awaiters.close();
+    }
+}
+
+
+manual_reset_event::~manual_reset_event() {
+    assert(m_awaiters.empty());
+}
+
+
+void manual_reset_event::set() noexcept {
+    auto first = m_awaiters.close();
+    if (m_awaiters.closed(first)) {
+        return;
+    }
+    resume_all(first);
+}
+
+
+void manual_reset_event::reset() noexcept {
+    m_awaiters.reopen();
+}
+
+
+bool manual_reset_event::is_set() const noexcept {
+    return m_awaiters.closed();
+}
+
+
+manual_reset_event::awaitable manual_reset_event::operator co_await() noexcept {
+    return { this };
+}
+
+
+bool auto_reset_event::awaitable::await_ready() const noexcept {
+    assert(m_owner);
+    return m_owner->try_acquire();
+}
+
+
+void auto_reset_event::awaitable::await_resume() const {
+    if (m_listener.cancelled()) {
+        throw operation_cancelled();
+    }
+}
+
+
+bool auto_reset_event::awaitable::try_cancel() noexcept {
+    assert(m_owner);
+    return m_owner->remove_awaiting(this);
+}
+
+
+auto_reset_event::auto_reset_event(bool is_set) noexcept : m_state(is_set ? set_bit : 0) {}
+
+
+auto_reset_event::~auto_reset_event() {
+    assert(m_awaiters.empty());
+}
+
+
+void auto_reset_event::set() noexcept {
+    auto state = m_state.load(std::memory_order_relaxed);
+    while (true) {
+        if (state == set_bit) {
+            return;
+        }
+        if (state & waiting_bit) {
+            if (set_waiting()) {
+                return;
+            }
+            state = m_state.load(std::memory_order_relaxed);
+        }
+        else if (m_state.compare_exchange_weak(state, set_bit, std::memory_order_release, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+
+bool auto_reset_event::set_waiting() noexcept {
+    awaitable* resumed = nullptr;
+    {
+        std::lock_guard lk(m_spinlock);
+        // The last awaiter may have been cancelled in the meantime.
+        if (!(m_state.load(std::memory_order_relaxed) & waiting_bit)) {
+            return false;
+        }
+        resumed = m_awaiters.pop_front();
+        assert(resumed);
+        if (m_awaiters.empty()) {
+            m_state.store(0, std::memory_order_relaxed);
+        }
+    }
+    assert(resumed->m_enclosing);
+    resumed->m_enclosing->resume();
+    return true;
+}
+
+
+void auto_reset_event::reset() noexcept {
+    auto state = set_bit;
+    m_state.compare_exchange_strong(state, 0, std::memory_order_relaxed);
+}
+
+
+bool auto_reset_event::is_set() const noexcept {
+    return m_state.load(std::memory_order_relaxed) == set_bit;
+}
+
+
+auto_reset_event::awaitable auto_reset_event::operator co_await() noexcept {
+    return { this };
+}
+
+
+bool auto_reset_event::try_acquire() noexcept {
+    auto state = set_bit;
+    return m_state.compare_exchange_strong(state, 0, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+
+bool auto_reset_event::acquire_or_wait(awaitable* waiting) noexcept {
+    std::lock_guard lk(m_spinlock);
+    auto state = m_state.load(std::memory_order_relaxed);
+    while (true) {
+        if (state == set_bit) {
+            if (m_state.compare_exchange_weak(state, 0, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        // Setters that see the bit take the lock, so they cannot miss the awaiter.
+        else if (m_state.compare_exchange_weak(state, waiting_bit, std::memory_order_relaxed, std::memory_order_relaxed)) {
+            m_awaiters.push_back(waiting);
+            return false;
+        }
+    }
+}
+
+
+bool auto_reset_event::remove_awaiting(awaitable* waiting) noexcept {
+    std::lock_guard lk(m_spinlock);
+    // Only the front of the queue has no predecessor.
+    if (waiting->m_prev == nullptr && m_awaiters.front() != waiting) {
+        return false;
+    }
+    m_awaiters.erase(waiting);
+    if (m_awaiters.empty()) {
+        m_state.store(0, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+} // namespace asyncpp
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include <asyncpp/latch.hpp>
+
+
+namespace asyncpp {
+
+bool latch::awaitable::await_ready() const noexcept {
+    assert(m_owner);
+    return m_owner->try_wait();
+}
+
+
+latch::latch(ptrdiff_t expected) noexcept : m_counter(expected) {
+    assert(expected >= 0);
+    if (expected == 0) {
+        m_awaiters.close();
+    }
+}
+
+
+latch::~latch() {
+    assert(m_awaiters.empty());
+}
+
+
+void latch::count_down(ptrdiff_t n) noexcept {
+    const auto previous = m_counter.fetch_sub(n, std::memory_order_acq_rel);
+    assert(previous >= n);
+    if (previous != n) {
+        return;
+    }
+    auto first = m_awaiters.close();
+    // Counting down by zero when the latch is ready.
+    if (m_awaiters.closed(first)) {
+        return;
+    }
+    resume_all(first);
+}
+
+
+bool latch::try_wait() const noexcept {
+    return m_counter.load(std::memory_order_acquire) == 0;
+}
+
+
+latch::awaitable latch::wait() noexcept {
+    return { this };
+}
+
+
+latch::awaitable latch::operator co_await() noexcept {
+    return wait();
+}
+
+
+latch::awaitable latch::arrive_and_wait(ptrdiff_t n) noexcept {
+    count_down(n);
+    return wait();
+}
+
+} // namespace asyncpp
\ No newline at end of file
@@ -11,12 +11,21 @@ bool mutex::awaitable::await_ready() const noexcept {
 }
 
 
-exclusively_locked_mutex<mutex> mutex::awaitable::await_resume() noexcept {
+exclusively_locked_mutex<mutex> mutex::awaitable::await_resume() {
     assert(m_owner);
+    if (m_listener.cancelled()) {
+        throw operation_cancelled();
+    }
     return { m_owner };
 }
 
 
+bool mutex::awaitable::try_cancel() noexcept {
+    assert(m_owner);
+    return m_owner->remove_awaiting(this);
+}
+
+
 mutex::~mutex() {
     std::lock_guard lk(m_spinlock);
     // Mutex must be unlocked before it's destroyed.
@@ -59,6 +68,17 @@ bool mutex::add_awaiting(awaitable* waiting) {
 }
 
 
+bool mutex::remove_awaiting(awaitable* waiting) noexcept {
+    std::lock_guard lk(m_spinlock);
+    // Waiting coroutines are queued behind the sentinel, so they have a predecessor until they acquire the lock.
+    if (waiting->m_prev != nullptr) {
+        m_queue.erase(waiting);
+        return true;
+    }
+    return false;
+}
+
+
 void mutex::unlock() {
     std::unique_lock lk(m_spinlock);
     assert(!m_queue.empty()); // Sentinel must be in the queue.
@@ -8,45 +8,88 @@ namespace asyncpp {
 
 bool counting_semaphore::awaitable::await_ready() const noexcept {
     assert(m_owner);
-    return m_owner->try_acquire();
+    return m_owner->try_acquire(m_count);
 }
 
 
-counting_semaphore::counting_semaphore(ptrdiff_t current_counter, ptrdiff_t max_counter) noexcept : m_counter(current_counter), m_max(max_counter) {
+void counting_semaphore::awaitable::await_resume() const {
+    if (m_listener.cancelled()) {
+        throw operation_cancelled();
+    }
+}
+
+
+bool counting_semaphore::awaitable::try_cancel() noexcept {
+    assert(m_owner);
+    return m_owner->remove_awaiting(this);
+}
+
+
+counting_semaphore::counting_semaphore(ptrdiff_t current_counter, ptrdiff_t max_counter) noexcept
+    : m_state(size_t(current_counter) * counter_unit), m_max(max_counter) {
     assert(0 <= current_counter && current_counter <= max_counter);
 }
 
 
-bool counting_semaphore::try_acquire() noexcept {
-    std::lock_guard lk(m_spinlock);
-    if (m_counter > 0) {
-        --m_counter;
-        return true;
+bool counting_semaphore::try_acquire(ptrdiff_t count) noexcept {
+    assert(0 <= count && count <= m_max);
+    const auto units = size_t(count) * counter_unit;
+    auto state = m_state.load(std::memory_order_relaxed);
+    while (!(state & waiting_bit) && state >= units) {
+        if (m_state.compare_exchange_weak(state, state - units, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return true;
+        }
     }
     return false;
 }
 
 
+counting_semaphore::awaitable counting_semaphore::acquire(ptrdiff_t count) noexcept {
+    assert(0 <= count && count <= m_max);
+    return { this, count };
+}
+
+
 counting_semaphore::awaitable counting_semaphore::operator co_await() noexcept {
     return { this };
 }
 
 
-void counting_semaphore::release() noexcept {
-    std::unique_lock lk(m_spinlock);
-    ++m_counter;
-    const auto resumed = m_awaiters.pop_front();
-    if (resumed) {
-        --m_counter;
-        lk.unlock();
-        assert(resumed->m_enclosing);
-        resumed->m_enclosing->resume();
-    }
-    else {
-        if (m_counter > m_max) {
+void counting_semaphore::release(ptrdiff_t count) noexcept {
+    assert(0 <= count);
+    const auto units = size_t(count) * counter_unit;
+    auto state = m_state.load(std::memory_order_relaxed);
+    while (!(state & waiting_bit)) {
+        if (ptrdiff_t(state / counter_unit) > m_max - count) {
             std::terminate(); // You released the semaphore too many times.
         }
+        if (m_state.compare_exchange_weak(state, state + units, std::memory_order_release, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    release_waiting(count);
+}
+
+
+void counting_semaphore::release_waiting(ptrdiff_t count) noexcept {
+    queue_type ready;
+    {
+        std::lock_guard lk(m_spinlock);
+        const auto state = m_state.load(std::memory_order_relaxed);
+        if (state & waiting_bit) {
+            if (ptrdiff_t(state / counter_unit) > m_max - count) {
+                std::terminate(); // You released the semaphore too many times.
+            }
+            m_state.fetch_add(size_t(count) * counter_unit, std::memory_order_relaxed);
+            collect_ready(ready);
+            count = 0;
+        }
+    }
+    if (count != 0) {
+        // The last awaiter was cancelled in the meantime.
+        release(count);
     }
+    resume_all(ready);
 }
 
 
@@ -56,11 +99,11 @@ ptrdiff_t counting_semaphore::max() const noexcept {
 
 
 ptrdiff_t counting_semaphore::_debug_get_counter() const noexcept {
-    return m_counter;
+    return ptrdiff_t(m_state.load() / counter_unit);
 }
 
 
-deque<counting_semaphore::awaitable, &counting_semaphore::awaitable::m_prev, &counting_semaphore::awaitable::m_next>& counting_semaphore::_debug_get_awaiters() {
+counting_semaphore::queue_type& counting_semaphore::_debug_get_awaiters() {
     return m_awaiters;
 }
 
@@ -68,21 +111,69 @@ deque<counting_semaphore::awaitable, &counting_semaphore::awaitable::m_prev, &co
 void counting_semaphore::_debug_clear() {
     m_awaiters.~deque();
     new (&m_awaiters) decltype(m_awaiters);
-    m_counter = m_max;
+    m_state = size_t(m_max) * counter_unit;
 }
 
 
-bool counting_semaphore::acquire(awaitable* waiting) noexcept {
+bool counting_semaphore::acquire_or_wait(awaitable* waiting) noexcept {
+    const auto units = size_t(waiting->m_count) * counter_unit;
     std::lock_guard lk(m_spinlock);
-    if (m_counter > 0) {
-        --m_counter;
-        return true;
+    auto state = m_state.load(std::memory_order_relaxed);
+    while (true) {
+        // Coroutines that are already waiting come first.
+        if (!(state & waiting_bit) && state >= units) {
+            if (m_state.compare_exchange_weak(state, state - units, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        // Releases that see the bit take the lock, so they cannot miss the awaiter.
+        else if (m_state.compare_exchange_weak(state, state | waiting_bit, std::memory_order_relaxed, std::memory_order_relaxed)) {
+            waiting->m_queued = true;
+            m_awaiters.push_back(waiting);
+            return false;
+        }
+    }
+}
+
+
+bool counting_semaphore::remove_awaiting(awaitable* waiting) noexcept {
+    queue_type ready;
+    {
+        std::lock_guard lk(m_spinlock);
+        // Awaiters that have been granted their units are already on their way to be resumed.
+        if (!waiting->m_queued) {
+            return false;
+        }
+        waiting->m_queued = false;
+        m_awaiters.erase(waiting);
+        // The awaiters behind a cancelled one may need fewer units.
+        collect_ready(ready);
     }
-    else {
-        m_awaiters.push_back(waiting);
-        return false;
+    resume_all(ready);
+    return true;
+}
+
+
+void counting_semaphore::collect_ready(queue_type& ready) noexcept {
+    while (const auto front = m_awaiters.front()) {
+        if (ptrdiff_t(m_state.load(std::memory_order_relaxed) / counter_unit) < front->m_count) {
+            return;
+        }
+        m_state.fetch_sub(size_t(front->m_count) * counter_unit, std::memory_order_acquire);
+        const auto awaiter = m_awaiters.pop_front();
+        awaiter->m_queued = false;
+        ready.push_back(awaiter);
+    }
+    m_state.fetch_and(~waiting_bit, std::memory_order_relaxed);
+}
+
+
+void counting_semaphore::resume_all(queue_type& ready) noexcept {
+    while (const auto resumed = ready.pop_front()) {
+        assert(resumed->m_enclosing);
+        resumed->m_enclosing->resume();
     }
 }
 
 
-} // namespace asyncpp
+} // namespace asyncpp
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <asyncpp/shared_mutex.hpp>
 
 #include <mutex>
+#include <utility>
 
 
 namespace asyncpp {
@@ -17,6 +18,18 @@ bool shared_mutex::shared_awaitable::await_ready() const noexcept {
 }
 
 
+bool shared_mutex::upgradable_awaitable::await_ready() const noexcept {
+    assert(m_owner);
+    return m_owner->try_lock_upgradable();
+}
+
+
+bool shared_mutex::upgrade_awaitable::await_ready() const noexcept {
+    assert(m_owner);
+    return m_owner->try_upgrade();
+}
+
+
 exclusively_locked_mutex<shared_mutex> shared_mutex::exclusive_awaitable::await_resume() const noexcept {
     assert(m_owner);
     return { m_owner };
@@ -29,18 +42,73 @@ shared_locked_mutex<shared_mutex> shared_mutex::shared_awaitable::await_resume()
 }
 
 
+upgradably_locked_mutex<shared_mutex> shared_mutex::upgradable_awaitable::await_resume() const noexcept {
+    assert(m_owner);
+    return { m_owner };
+}
+
+
+exclusively_locked_mutex<shared_mutex> shared_mutex::upgrade_awaitable::await_resume() const noexcept {
+    assert(m_owner);
+    return { m_owner };
+}
+
+
+shared_mutex::shared_mutex(shared_mutex_policy policy) noexcept : m_policy(policy) {}
+
+
 shared_mutex::~shared_mutex() {
     std::lock_guard lk(m_spinlock);
     // Mutex must be released before destroying.
-    if (!m_queue.empty()) {
+    if (m_exclusive || m_upgradable || m_shared_count != 0 || !m_exclusive_queue.empty() || !m_shared_queue.empty() || !m_upgradable_queue.empty()) {
         std::terminate();
     }
 }
 
+
+bool shared_mutex::can_lock() const noexcept {
+    if (m_exclusive || m_upgradable || m_shared_count != 0 || !m_exclusive_queue.empty()) {
+        return false;
+    }
+    // Readers only wait without waiting writers when the mutex is locked exclusively.
+    return m_shared_queue.empty() && m_upgradable_queue.empty();
+}
+
+
+bool shared_mutex::can_lock_shared() const noexcept {
+    if (m_exclusive || m_upgrading) {
+        return false;
+    }
+    switch (m_policy) {
+        case shared_mutex_policy::fifo: return m_exclusive_queue.empty() && m_shared_queue.empty() && m_upgradable_queue.empty();
+        case shared_mutex_policy::reader_preferring: return true;
+        case shared_mutex_policy::writer_preferring: return m_exclusive_queue.empty();
+        case shared_mutex_policy::phase_fair: return m_exclusive_queue.empty();
+    }
+    return false;
+}
+
+
+bool shared_mutex::can_lock_upgradable() const noexcept {
+    return !m_upgradable && m_upgradable_queue.empty() && can_lock_shared();
+}
+
+
+bool shared_mutex::upgrade_now() noexcept {
+    assert(m_upgradable && !m_upgrading);
+    if (m_shared_count == 0) {
+        m_upgradable = false;
+        m_exclusive = true;
+        return true;
+    }
+    return false;
+}
+
+
 bool shared_mutex::try_lock() noexcept {
     std::lock_guard lk(m_spinlock);
-    if (m_queue.empty()) {
-        m_queue.push_back(&m_exclusive_sentinel);
+    if (can_lock()) {
+        m_exclusive = true;
         return true;
     }
     return false;
@@ -49,19 +117,30 @@ bool shared_mutex::try_lock() noexcept {
 
 bool shared_mutex::try_lock_shared() noexcept {
     std::lock_guard lk(m_spinlock);
-    if (m_queue.empty()) {
-        m_queue.push_back(&m_shared_sentinel);
+    if (can_lock_shared()) {
         ++m_shared_count;
         return true;
     }
-    if (m_queue.back() == &m_shared_sentinel) {
-        ++m_shared_count;
+    return false;
+}
+
+
+bool shared_mutex::try_lock_upgradable() noexcept {
+    std::lock_guard lk(m_spinlock);
+    if (can_lock_upgradable()) {
+        m_upgradable = true;
         return true;
     }
     return false;
 }
 
 
+bool shared_mutex::try_upgrade() noexcept {
+    std::lock_guard lk(m_spinlock);
+    return upgrade_now();
+}
+
+
 shared_mutex::exclusive_awaitable shared_mutex::exclusive() noexcept {
     return exclusive_awaitable{ this };
 }
@@ -72,33 +151,47 @@ shared_mutex::shared_awaitable shared_mutex::shared() noexcept {
 }
 
 
+shared_mutex::upgradable_awaitable shared_mutex::upgradable() noexcept {
+    return upgradable_awaitable{ this };
+}
+
+
+shared_mutex::upgrade_awaitable shared_mutex::upgrade() noexcept {
+    return upgrade_awaitable{ this };
+}
+
+
 bool shared_mutex::add_awaiting(basic_awaitable* waiting) {
     std::lock_guard lk(m_spinlock);
-    const auto previous = m_queue.push_back(waiting);
     if (waiting->m_type == awaitable_type::exclusive) {
-        // We've just acquire the exclusive lock.
-        if (previous == nullptr) {
-            m_queue.push_back(&m_exclusive_sentinel);
-            m_queue.pop_front();
+        if (can_lock()) {
+            m_exclusive = true;
             return true;
         }
+        waiting->m_ticket = m_next_ticket++;
+        m_exclusive_queue.push_back(waiting);
     }
     else if (waiting->m_type == awaitable_type::shared) {
-        // We've just acquire the exclusive lock.
-        if (previous == nullptr) {
-            m_queue.push_back(&m_shared_sentinel);
-            m_queue.pop_front();
+        if (can_lock_shared()) {
             ++m_shared_count;
             return true;
         }
-        // We've just acquired the shared lock.
-        if (previous == &m_shared_sentinel) {
-            m_queue.pop_front(); // Pop old sentinel.
-            m_queue.pop_front(); // Pop just added awaitable.
-            m_queue.push_back(&m_shared_sentinel);
-            ++m_shared_count;
+        waiting->m_ticket = m_next_ticket++;
+        m_shared_queue.push_back(waiting);
+    }
+    else if (waiting->m_type == awaitable_type::upgradable) {
+        if (can_lock_upgradable()) {
+            m_upgradable = true;
+            return true;
+        }
+        waiting->m_ticket = m_next_ticket++;
+        m_upgradable_queue.push_back(waiting);
+    }
+    else if (waiting->m_type == awaitable_type::upgrade) {
+        if (upgrade_now()) {
             return true;
         }
+        m_upgrading = waiting;
     }
     else {
         assert(false && "improperly initialized awaiter");
@@ -107,17 +200,82 @@ bool shared_mutex::add_awaiting(basic_awaitable* waiting) {
 }
 
 
-void shared_mutex::continue_waiting(std::unique_lock<spinlock>& lk) {
-    decltype(m_queue) unblocked;
+void shared_mutex::unblock_exclusive(queue_type& unblocked) noexcept {
+    if (!m_exclusive && !m_upgradable && m_shared_count == 0 && !m_exclusive_queue.empty()) {
+        m_exclusive = true;
+        unblocked.push_back(m_exclusive_queue.pop_front());
+    }
+}
+
 
-    const auto type = m_queue.front() ? m_queue.front()->m_type : awaitable_type::unknown;
-    if (type == awaitable_type::exclusive) {
-        assert(!m_queue.empty()); // Must not be empty as the front is exclusive.
-        unblocked.push_back(m_queue.pop_front());
+void shared_mutex::unblock_shared(queue_type& unblocked) noexcept {
+    if (m_exclusive) {
+        return;
     }
-    else if (type == awaitable_type::shared) {
-        while (m_queue.front() && m_queue.front()->m_type == awaitable_type::shared) {
-            unblocked.push_back(m_queue.pop_front());
+    const auto first_writer = m_exclusive_queue.front();
+    while (const auto front = m_shared_queue.front()) {
+        // Readers that came after the first waiting writer wait for it in FIFO mode.
+        if (m_policy == shared_mutex_policy::fifo && first_writer && first_writer->m_ticket < front->m_ticket) {
+            break;
+        }
+        ++m_shared_count;
+        unblocked.push_back(m_shared_queue.pop_front());
+    }
+    const auto upgradable = m_upgradable_queue.front();
+    if (!m_upgradable && upgradable) {
+        if (m_policy != shared_mutex_policy::fifo || !first_writer || upgradable->m_ticket < first_writer->m_ticket) {
+            m_upgradable = true;
+            unblocked.push_back(m_upgradable_queue.pop_front());
+        }
+    }
+}
+
+
+void shared_mutex::continue_waiting(std::unique_lock<spinlock>& lk, bool after_exclusive) {
+    queue_type unblocked;
+
+    if (m_upgrading) {
+        // The holder of the upgradable lock goes first, as soon as the readers are gone.
+        if (m_shared_count == 0) {
+            m_upgradable = false;
+            m_exclusive = true;
+            unblocked.push_back(std::exchange(m_upgrading, nullptr));
+        }
+    }
+    else {
+        const auto first_writer = m_exclusive_queue.front();
+        auto first_reader = m_shared_queue.front();
+        if (const auto upgradable = m_upgradable_queue.front(); !first_reader || (upgradable && upgradable->m_ticket < first_reader->m_ticket)) {
+            first_reader = upgradable;
+        }
+        switch (m_policy) {
+            case shared_mutex_policy::fifo:
+                if (first_writer && (!first_reader || first_writer->m_ticket < first_reader->m_ticket)) {
+                    unblock_exclusive(unblocked);
+                }
+                else {
+                    unblock_shared(unblocked);
+                }
+                break;
+            case shared_mutex_policy::reader_preferring:
+                unblock_shared(unblocked);
+                unblock_exclusive(unblocked);
+                break;
+            case shared_mutex_policy::writer_preferring:
+                unblock_exclusive(unblocked);
+                if (m_exclusive_queue.empty()) {
+                    unblock_shared(unblocked);
+                }
+                break;
+            case shared_mutex_policy::phase_fair:
+                if (after_exclusive) {
+                    unblock_shared(unblocked);
+                }
+                unblock_exclusive(unblocked);
+                if (m_exclusive_queue.empty()) {
+                    unblock_shared(unblocked);
+                }
+                break;
         }
     }
 
@@ -131,36 +289,60 @@ void shared_mutex::continue_waiting(std::unique_lock<spinlock>& lk) {
 
 void shared_mutex::unlock() {
     std::unique_lock lk(m_spinlock);
-    assert(m_queue.front() == &m_exclusive_sentinel);
-    m_queue.pop_front();
-    continue_waiting(lk);
+    assert(m_exclusive);
+    m_exclusive = false;
+    continue_waiting(lk, true);
 }
 
 
 void shared_mutex::unlock_shared() {
     std::unique_lock lk(m_spinlock);
-    assert(m_queue.front() == &m_shared_sentinel);
+    assert(m_shared_count != 0);
     if (--m_shared_count == 0) {
-        m_queue.pop_front();
-        continue_waiting(lk);
+        continue_waiting(lk, false);
     }
 }
 
 
+void shared_mutex::unlock_upgradable() {
+    std::unique_lock lk(m_spinlock);
+    assert(m_upgradable && !m_upgrading);
+    m_upgradable = false;
+    continue_waiting(lk, false);
+}
+
+
+shared_mutex_policy shared_mutex::policy() const noexcept {
+    return m_policy;
+}
+
+
 void shared_mutex::_debug_clear() noexcept {
-    m_queue.~deque();
-    new (&m_queue) decltype(m_queue);
+    m_exclusive_queue.~deque();
+    new (&m_exclusive_queue) decltype(m_exclusive_queue);
+    m_shared_queue.~deque();
+    new (&m_shared_queue) decltype(m_shared_queue);
+    m_upgradable_queue.~deque();
+    new (&m_upgradable_queue) decltype(m_upgradable_queue);
+    m_exclusive = false;
+    m_upgradable = false;
+    m_upgrading = nullptr;
     m_shared_count = 0;
 }
 
 
 bool shared_mutex::_debug_is_exclusive_locked() const noexcept {
-    return m_queue.front() == &m_exclusive_sentinel;
+    return m_exclusive;
 }
 
 
 size_t shared_mutex::_debug_is_shared_locked() const noexcept {
-    return m_queue.front() == &m_shared_sentinel ? m_shared_count : 0;
+    return m_shared_count;
+}
+
+
+bool shared_mutex::_debug_is_upgradable_locked() const noexcept {
+    return m_upgradable;
 }
 
-} // namespace asyncpp
+} // namespace asyncpp
\ No newline at end of file
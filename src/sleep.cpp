@@ -1,20 +1,81 @@
 #include <asyncpp/sleep.hpp>
+#include <asyncpp/threading/cache.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <vector>
 
 
 namespace asyncpp {
 
 namespace impl_sleep {
 
-    struct awaiter_priority {
-        bool operator()(const awaitable* lhs, const awaitable* rhs) const noexcept {
-            return lhs->get_time() > rhs->get_time();
+    using timer_list = timer_queue::wheel_type::list;
+    constexpr auto never = timer_queue::wheel_type::never;
+
+    // The length of one tick of the timer wheels. Timers are rounded up to whole ticks.
+    using tick_type = std::chrono::milliseconds;
+    constexpr tick_type tick_duration(1);
+
+
+    // All timer queues count ticks from the same epoch so that timers can be moved between them.
+    static clock_type::time_point epoch() noexcept {
+        static const auto value = clock_type::now();
+        return value;
+    }
+
+
+    // The global granularity in ticks.
+    static std::atomic<uint64_t> granularity = 1;
+
+
+    static clock_type::time_point to_time(uint64_t tick) noexcept {
+        return epoch() + static_cast<int64_t>(tick) * tick_duration;
+    }
+
+
+    // The last tick whose time point is representable, timers that are due later fire at this tick.
+    static uint64_t max_tick() noexcept {
+        static const auto value = static_cast<uint64_t>(std::chrono::floor<tick_type>(clock_type::time_point::max() - epoch()) / tick_duration);
+        return value;
+    }
+
+
+    // Clamps the time point so that the arithmetic on it cannot overflow, such as for `sleep_until(time_point::max())`.
+    static clock_type::time_point saturate(clock_type::time_point time) noexcept {
+        return std::clamp(time, epoch(), to_time(max_tick()));
+    }
+
+
+    static uint64_t to_tick(clock_type::time_point time) noexcept {
+        return static_cast<uint64_t>(std::chrono::ceil<tick_type>(saturate(time) - epoch()) / tick_duration);
+    }
+
+
+    static uint64_t to_tick(clock_type::time_point time, clock_type::duration slack) noexcept {
+        const auto earliest = to_tick(time);
+        const auto start = saturate(time);
+        const auto end = start + std::min(slack, to_time(max_tick()) - start);
+        const auto latest = static_cast<uint64_t>(std::chrono::floor<tick_type>(end - epoch()) / tick_duration);
+        const auto due = coalesce(earliest, std::max(earliest, latest), granularity.load(std::memory_order_relaxed));
+        return std::min(due, max_tick());
+    }
+
+
+    static uint64_t current_tick() noexcept {
+        return static_cast<uint64_t>(std::chrono::floor<tick_type>(clock_type::now() - epoch()) / tick_duration);
+    }
+
+
+    static void resume_all(timer_list& expired) {
+        while (const auto awaiter = expired.pop_front()) {
+            awaiter->m_enclosing->resume();
         }
-    };
+    }
 
 
     class sleep_scheduler {
@@ -25,7 +86,14 @@ namespace impl_sleep {
         sleep_scheduler& operator=(const sleep_scheduler&) = delete;
         ~sleep_scheduler() {
             m_thread.request_stop();
-            m_cvar.notify_all();
+            m_thread.join();
+            // Timers still pending at exit never fire, and must not be handed over to the scheduler itself.
+            for (size_t index = 0; index < m_num_shards; ++index) {
+                auto& shard = m_shards[index];
+                timer_list dropped;
+                std::lock_guard lk(shard.m_mutex);
+                shard.m_wheel.clear(dropped);
+            }
         }
 
         static sleep_scheduler& get() {
@@ -34,63 +102,214 @@ namespace impl_sleep {
         }
 
         void enqueue(awaitable* awaiter) noexcept {
+            const auto due = m_shards[local_shard()].insert(awaiter);
+            // Only wake the timer thread if it's going to sleep past the new timer.
+            if (due < m_wake_tick.load(std::memory_order_acquire)) {
+                std::lock_guard lk(m_mutex);
+                if (due < m_wake_tick.load(std::memory_order_relaxed)) {
+                    m_wake_tick.store(due, std::memory_order_relaxed);
+                    m_cvar.notify_one();
+                }
+            }
+        }
+
+        timer_queue* reuse() {
+            std::lock_guard lk(m_retired_mutex);
+            if (m_retired.empty()) {
+                return new timer_queue;
+            }
+            const auto queue = m_retired.back().release();
+            m_retired.pop_back();
+            return queue;
+        }
+
+        void retire(timer_queue* queue) noexcept {
             {
-                std::lock_guard lk(m_mtx);
-                m_queue.push(awaiter);
+                std::lock_guard lk(queue->m_mutex);
+                timer_list pending;
+                queue->m_wheel.clear(pending);
+                queue->m_next_tick.store(never, std::memory_order_relaxed);
+                // The lock is held so that cancellation waits until the timer has moved to its new queue.
+                while (const auto awaiter = pending.pop_front()) {
+                    enqueue(awaiter);
+                }
             }
-            m_cvar.notify_one();
+            std::lock_guard lk(m_retired_mutex);
+            m_retired.emplace_back(queue);
         }
 
     private:
+        sleep_scheduler()
+            : m_num_shards(std::max(1u, std::thread::hardware_concurrency())),
+              m_shards(std::make_unique<timer_queue[]>(m_num_shards)) {
+            epoch();
+            m_thread = std::jthread([this](std::stop_token token) { awake(token); });
+        }
+
         void awake(std::stop_token token) {
-            const auto stop_condition = [&] { return token.stop_requested() || !m_queue.empty(); };
+            timer_list expired;
             while (!token.stop_requested()) {
-                std::unique_lock lk(m_mtx);
-                if (m_queue.empty()) {
-                    m_cvar.wait(lk, stop_condition);
+                {
+                    std::lock_guard lk(m_mutex);
+                    m_wake_tick.store(never, std::memory_order_relaxed);
+                }
+
+                const auto now = current_tick();
+                auto next = never;
+                for (size_t index = 0; index < m_num_shards; ++index) {
+                    auto& shard = m_shards[index];
+                    shard.collect(now, expired);
+                    next = std::min(next, shard.m_next_tick.load(std::memory_order_relaxed));
+                }
+
+                // All due timers of all shards are resumed in one batch outside the locks.
+                resume_all(expired);
+
+                std::unique_lock lk(m_mutex);
+                const auto wake = std::min(next, m_wake_tick.load(std::memory_order_relaxed));
+                m_wake_tick.store(wake, std::memory_order_relaxed);
+                const auto rescheduled = [&] { return m_wake_tick.load(std::memory_order_relaxed) < wake; };
+                if (wake == never) {
+                    m_cvar.wait(lk, token, rescheduled);
                 }
                 else {
-                    const auto next = m_queue.top();
-                    m_cvar.wait_until(lk, next->get_time(), stop_condition);
-                    if (next->get_time() <= clock_type::now()) {
-                        m_queue.pop();
-                        lk.unlock();
-                        next->m_enclosing->resume();
-                    }
+                    m_cvar.wait_until(lk, token, to_time(wake), rescheduled);
                 }
             }
         }
 
-        sleep_scheduler() {
-            m_thread = std::jthread([this](std::stop_token token) { awake(token); });
+        size_t local_shard() noexcept {
+            thread_local const size_t index = m_next_shard.fetch_add(1, std::memory_order_relaxed) % m_num_shards;
+            return index;
         }
 
     private:
-        std::priority_queue<awaitable*, std::vector<awaitable*>, awaiter_priority> m_queue;
-        std::mutex m_mtx;
-        std::condition_variable m_cvar;
+        const size_t m_num_shards;
+        std::unique_ptr<timer_queue[]> m_shards;
+        std::atomic_size_t m_next_shard = 0;
+        alignas(avoid_false_sharing) std::atomic<uint64_t> m_wake_tick = 0;
+        std::mutex m_mutex;
+        std::condition_variable_any m_cvar;
+        std::mutex m_retired_mutex;
+        std::vector<std::unique_ptr<timer_queue>> m_retired;
         std::jthread m_thread;
     };
 
-    awaitable::awaitable(clock_type::time_point time) noexcept
-        : m_time(time) {}
+
+    void timer_queue::retire::operator()(timer_queue* queue) const noexcept {
+        sleep_scheduler::get().retire(queue);
+    }
+
+
+    auto timer_queue::create() -> handle {
+        return handle(sleep_scheduler::get().reuse());
+    }
+
+
+    timer_queue* timer_queue::local() noexcept {
+        return m_local;
+    }
+
+
+    void timer_queue::install(timer_queue* queue) noexcept {
+        m_local = queue;
+    }
+
+
+    uint64_t timer_queue::insert(awaitable* awaiter) noexcept {
+        awaiter->m_tick = to_tick(awaiter->get_time(), awaiter->get_slack());
+        std::lock_guard lk(m_mutex);
+        std::atomic_ref(awaiter->m_queue).store(this, std::memory_order_release);
+        const auto due = m_wheel.insert(awaiter);
+        if (due < m_next_tick.load(std::memory_order_relaxed)) {
+            m_next_tick.store(due, std::memory_order_release);
+        }
+        return due;
+    }
+
+
+    bool timer_queue::remove(awaitable* awaiter) noexcept {
+        std::atomic_ref queue_ref(awaiter->m_queue);
+        while (true) {
+            const auto queue = queue_ref.load(std::memory_order_acquire);
+            std::lock_guard lk(queue->m_mutex);
+            // The timer may have been handed over to another queue in the meantime.
+            if (queue == queue_ref.load(std::memory_order_relaxed)) {
+                return queue->m_wheel.erase(awaiter);
+            }
+        }
+    }
+
+
+    void timer_queue::expire() {
+        const auto next = m_next_tick.load(std::memory_order_acquire);
+        if (next == never) {
+            return;
+        }
+        const auto now = current_tick();
+        if (now < next) {
+            return;
+        }
+        timer_list expired;
+        collect(now, expired);
+        resume_all(expired);
+    }
+
+
+    clock_type::time_point timer_queue::next_deadline() const noexcept {
+        const auto next = m_next_tick.load(std::memory_order_acquire);
+        return next == never ? clock_type::time_point::max() : to_time(next);
+    }
+
+
+    void timer_queue::collect(uint64_t now, timer_list& expired) noexcept {
+        std::lock_guard lk(m_mutex);
+        m_wheel.advance(now, expired);
+        m_next_tick.store(m_wheel.next_tick(), std::memory_order_release);
+    }
+
+
+    awaitable::awaitable(clock_type::time_point time, clock_type::duration slack) noexcept
+        : m_time(time), m_slack(std::max(clock_type::duration(0), slack)) {}
 
     bool awaitable::await_ready() const noexcept {
         return m_time < clock_type::now();
     }
 
-    void awaitable::await_resume() const noexcept {
-        return;
+    void awaitable::await_resume() const {
+        if (m_listener.cancelled()) {
+            throw operation_cancelled();
+        }
+    }
+
+    bool awaitable::try_cancel() noexcept {
+        return timer_queue::remove(this);
     }
 
     void awaitable::enqueue() noexcept {
-        sleep_scheduler::get().enqueue(this);
+        // Timers are fired by the thread's own event loop if it has one.
+        if (const auto queue = timer_queue::local()) {
+            queue->insert(this);
+        }
+        else {
+            sleep_scheduler::get().enqueue(this);
+        }
     }
 
     auto awaitable::get_time() const noexcept -> clock_type::time_point {
         return m_time;
     }
 
+    auto awaitable::get_slack() const noexcept -> clock_type::duration {
+        return m_slack;
+    }
+
 } // namespace impl_sleep
 
+
+void set_sleep_granularity(impl_sleep::clock_type::duration granularity) noexcept {
+    const auto ticks = std::chrono::ceil<impl_sleep::tick_type>(granularity) / impl_sleep::tick_duration;
+    impl_sleep::granularity.store(static_cast<uint64_t>(std::max<int64_t>(1, ticks)), std::memory_order_relaxed);
+}
+
 } // namespace asyncpp
\ No newline at end of file
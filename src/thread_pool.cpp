@@ -59,7 +59,7 @@ schedulable_promise* thread_pool::worker::try_get_promise(pack& pack, size_t& st
         pack.blocked.push(this);
         pack.num_blocked.fetch_add(1, std::memory_order_relaxed);
         INTERLEAVED(lk.unlock());
-        INTERLEAVED_ACQUIRE(m_sema.acquire());
+        park();
         INTERLEAVED(m_blocked.clear());
         stealing_attempt = pack.workers.size();
     }
@@ -94,16 +94,34 @@ void thread_pool::worker::cancel() {
 }
 
 
+void thread_pool::worker::park() {
+    // Wake up for the sleeping coroutines' timers while waiting for work. The worker stays
+    // on the blocked list all along, so it must not return before the semaphore is acquired.
+    auto deadline = m_timers->next_deadline();
+    while (deadline != impl_sleep::clock_type::time_point::max()) {
+        if (m_sema.try_acquire_until(deadline)) {
+            return;
+        }
+        m_timers->expire();
+        deadline = m_timers->next_deadline();
+    }
+    INTERLEAVED_ACQUIRE(m_sema.acquire());
+}
+
+
 void thread_pool::worker::run(pack& pack) {
     m_local = this;
+    impl_sleep::timer_queue::install(m_timers.get());
     size_t stealing_attempt = pack.workers.size();
     bool exit_loop = false;
     while (!exit_loop) {
+        m_timers->expire();
         const auto promise = try_get_promise(pack, stealing_attempt, exit_loop);
         if (promise) {
             promise->resume_now();
         }
     }
+    impl_sleep::timer_queue::install(nullptr);
 }
 
 
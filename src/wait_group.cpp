@@ -0,0 +1,60 @@
+#include <asyncpp/wait_group.hpp>
+
+
+namespace asyncpp {
+
+bool wait_group::awaitable::await_ready() const noexcept {
+    assert(m_owner);
+    return m_owner->m_counter.load(std::memory_order_acquire) == 0;
+}
+
+
+wait_group::wait_group() noexcept {
+    m_awaiters.close();
+}
+
+
+wait_group::~wait_group() {
+    assert(m_awaiters.empty());
+}
+
+
+void wait_group::add(ptrdiff_t n) noexcept {
+    assert(n >= 0);
+    const auto previous = m_counter.fetch_add(n, std::memory_order_acq_rel);
+    if (previous == 0 && n != 0) {
+        m_awaiters.reopen();
+    }
+}
+
+
+void wait_group::done() noexcept {
+    const auto previous = m_counter.fetch_sub(1, std::memory_order_acq_rel);
+    assert(previous > 0);
+    if (previous != 1) {
+        return;
+    }
+    auto first = m_awaiters.close();
+    // The `add` that made the group non-empty may not have reopened it yet.
+    if (m_awaiters.closed(first)) {
+        return;
+    }
+    resume_all(first);
+}
+
+
+wait_group::awaitable wait_group::wait() noexcept {
+    return { this };
+}
+
+
+wait_group::awaitable wait_group::operator co_await() noexcept {
+    return wait();
+}
+
+
+ptrdiff_t wait_group::_debug_get_counter() const noexcept {
+    return m_counter.load();
+}
+
+} // namespace asyncpp
\ No newline at end of file
@@ -82,6 +82,22 @@ TEST_CASE("Atomic collection: push to closed", "[Atomic collection]") {
 }
 
 
+TEST_CASE("Atomic collection: reopen", "[Atomic collection]") {
+    collection_t collection;
+    collection_element e1{ 1 };
+    REQUIRE(!collection.reopen());
+    collection.push(&e1);
+    REQUIRE(!collection.reopen());
+    REQUIRE(collection.first() == &e1);
+    collection.detach();
+    collection.close();
+    REQUIRE(collection.reopen());
+    REQUIRE(!collection.closed());
+    REQUIRE(collection.empty());
+    REQUIRE(!collection_t::closed(collection.push(&e1)));
+}
+
+
 TEST_CASE("Atomic collection: push-push interleave", "[Atomic collection]") {
     struct scenario : testing::validated_scenario {
         collection_t collection;
@@ -105,3 +105,39 @@ TEST_CASE("Atomic deque - pop_back", "[Atomic deque]") {
 
     REQUIRE(c.pop_back() == nullptr);
 }
+
+
+TEST_CASE("Atomic deque - erase", "[Atomic deque]") {
+    deque_t c;
+    element e1, e2, e3;
+    c.push_back(&e1);
+    c.push_back(&e2);
+    c.push_back(&e3);
+
+    SECTION("front") {
+        c.erase(&e1);
+        REQUIRE(c.front() == &e2);
+        REQUIRE(c.back() == &e3);
+        REQUIRE(e2.prev == nullptr);
+    }
+    SECTION("middle") {
+        c.erase(&e2);
+        REQUIRE(c.front() == &e1);
+        REQUIRE(c.back() == &e3);
+        REQUIRE(e1.next == &e3);
+        REQUIRE(e3.prev == &e1);
+    }
+    SECTION("back") {
+        c.erase(&e3);
+        REQUIRE(c.front() == &e1);
+        REQUIRE(c.back() == &e2);
+        REQUIRE(e2.next == nullptr);
+    }
+    SECTION("all") {
+        c.erase(&e2);
+        c.erase(&e1);
+        c.erase(&e3);
+        REQUIRE(c.empty());
+        REQUIRE(c.front() == nullptr);
+    }
+}
\ No newline at end of file
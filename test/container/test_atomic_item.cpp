@@ -63,6 +63,27 @@ TEST_CASE("Atomic item: close", "[Atomic item]") {
 }
 
 
+TEST_CASE("Atomic item: remove", "[Atomic item]") {
+    item_t item;
+    element e1{ 1 };
+    element e2{ 2 };
+    item.set(&e1);
+    SECTION("same") {
+        REQUIRE(item.remove(&e1));
+        REQUIRE(item.item() == nullptr);
+    }
+    SECTION("other") {
+        REQUIRE(!item.remove(&e2));
+        REQUIRE(item.item() == &e1);
+    }
+    SECTION("closed") {
+        item.close();
+        REQUIRE(!item.remove(&e1));
+        REQUIRE(item.closed());
+    }
+}
+
+
 TEST_CASE("Atomic item: push-push interleave", "[Atomic item]") {
     struct scenario : testing::validated_scenario {
         item_t item;
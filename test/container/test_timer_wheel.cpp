@@ -0,0 +1,104 @@
+#include <asyncpp/container/timer_wheel.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+
+using namespace asyncpp;
+
+
+struct element {
+    element* next = nullptr;
+    element* prev = nullptr;
+    uint64_t tick = 0;
+    size_t slot = 0;
+};
+
+
+using wheel_t = timer_wheel<element, &element::prev, &element::next, &element::tick, &element::slot>;
+
+
+static std::vector<element*> expire(wheel_t& wheel, uint64_t now) {
+    wheel_t::list expired;
+    wheel.advance(now, expired);
+    std::vector<element*> elements;
+    while (const auto e = expired.pop_front()) {
+        elements.push_back(e);
+    }
+    return elements;
+}
+
+
+TEST_CASE("Timer wheel - empty", "[Timer wheel]") {
+    wheel_t wheel;
+    REQUIRE(wheel.empty());
+    REQUIRE(wheel.next_tick() == wheel_t::never);
+    REQUIRE(expire(wheel, 1000).empty());
+    REQUIRE(wheel.current() == 1001);
+}
+
+
+TEST_CASE("Timer wheel - insert & expire", "[Timer wheel]") {
+    wheel_t wheel;
+    element e{ .tick = 10 };
+    REQUIRE(wheel.insert(&e) == 10);
+    REQUIRE(wheel.size() == 1);
+    REQUIRE(wheel.next_tick() == 0); // Cascade boundary.
+    REQUIRE(expire(wheel, 9).empty());
+    REQUIRE(wheel.next_tick() == 10);
+    REQUIRE(expire(wheel, 10) == std::vector{ &e });
+    REQUIRE(wheel.empty());
+    REQUIRE(e.slot == wheel_t::no_slot);
+}
+
+
+TEST_CASE("Timer wheel - already due", "[Timer wheel]") {
+    wheel_t wheel;
+    REQUIRE(expire(wheel, 99).empty());
+    element e{ .tick = 50 };
+    REQUIRE(wheel.insert(&e) == 100);
+    REQUIRE(expire(wheel, 100) == std::vector{ &e });
+}
+
+
+TEST_CASE("Timer wheel - erase", "[Timer wheel]") {
+    wheel_t wheel;
+    element e1{ .tick = 10 };
+    element e2{ .tick = 100000 };
+    wheel.insert(&e1);
+    wheel.insert(&e2);
+    REQUIRE(wheel.erase(&e1));
+    REQUIRE(!wheel.erase(&e1));
+    REQUIRE(wheel.erase(&e2));
+    REQUIRE(wheel.empty());
+    REQUIRE(expire(wheel, 200000).empty());
+}
+
+
+TEST_CASE("Timer wheel - cascade", "[Timer wheel]") {
+    std::mt19937_64 rne(723563);
+    std::uniform_int_distribution<uint64_t> dist(0, uint64_t(1) << 25); // Beyond the last level.
+    std::vector<element> elements(1000);
+    wheel_t wheel;
+    for (auto& e : elements) {
+        e.tick = dist(rne);
+        wheel.insert(&e);
+    }
+    uint64_t now = 0;
+    size_t num_expired = 0;
+    while (!wheel.empty()) {
+        const auto next = wheel.next_tick();
+        REQUIRE(next >= now);
+        now = next;
+        // Timers must expire exactly on their tick, neither skipped nor early.
+        for (const auto e : expire(wheel, now)) {
+            REQUIRE(e->tick == now);
+            ++num_expired;
+        }
+        ++now;
+    }
+    REQUIRE(num_expired == elements.size());
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include <asyncpp/async_generator.hpp>
+#include <asyncpp/event.hpp>
+#include <asyncpp/join.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+
+using namespace asyncpp;
+
+
+static async_generator<int> iota(int count) {
+    for (int i = 0; i < count; ++i) {
+        co_yield i;
+    }
+}
+
+
+static task<std::vector<int>> collect(async_generator<int> g) {
+    std::vector<int> values;
+    while (const auto item = co_await g) {
+        values.push_back(*item);
+    }
+    co_return values;
+}
+
+
+TEST_CASE("Async generator: creation", "[Async generator]") {
+    SECTION("empty") {
+        async_generator<int> g;
+        REQUIRE(!g.valid());
+    }
+    SECTION("valid") {
+        auto g = iota(1);
+        REQUIRE(g.valid());
+    }
+}
+
+
+TEST_CASE("Async generator: iteration", "[Async generator]") {
+    SECTION("values") {
+        REQUIRE(join(collect(iota(4))) == std::vector{ 0, 1, 2, 3 });
+    }
+    SECTION("empty") {
+        REQUIRE(join(collect(iota(0))).empty());
+    }
+    SECTION("finished") {
+        static const auto coro = [](async_generator<int>& g) -> task<bool> {
+            while (co_await g) {
+            }
+            const auto item = co_await g;
+            co_return !item;
+        };
+        auto g = iota(2);
+        REQUIRE(join(coro(g)));
+    }
+}
+
+
+TEST_CASE("Async generator: data types", "[Async generator]") {
+    SECTION("reference") {
+        static const auto producer = [](std::string& value) -> async_generator<std::string&> {
+            co_yield value;
+        };
+        static const auto consumer = [](async_generator<std::string&> g) -> task<std::string*> {
+            const auto item = co_await g;
+            co_return &*item;
+        };
+        std::string value = "test";
+        REQUIRE(join(consumer(producer(value))) == &value);
+    }
+    SECTION("movable") {
+        static const auto producer = []() -> async_generator<std::unique_ptr<int>> {
+            co_yield std::make_unique<int>(3);
+        };
+        static const auto consumer = [](async_generator<std::unique_ptr<int>> g) -> task<int> {
+            const auto item = co_await g;
+            const auto value = std::move(*item);
+            co_return *value;
+        };
+        REQUIRE(join(consumer(producer())) == 3);
+    }
+    SECTION("lvalue") {
+        static const auto producer = []() -> async_generator<std::string> {
+            std::string value = "test";
+            co_yield value;
+            co_yield value;
+        };
+        static const auto consumer = [](async_generator<std::string> g) -> task<std::string> {
+            const auto first = co_await g;
+            *first = "modified";
+            const auto second = co_await g;
+            co_return *second;
+        };
+        REQUIRE(join(consumer(producer())) == "test");
+    }
+}
+
+
+TEST_CASE("Async generator: co_await in body", "[Async generator]") {
+    static const auto producer = [](event<int>& evt) -> async_generator<int> {
+        co_yield 1;
+        co_yield co_await evt;
+        co_yield 3;
+    };
+    event<int> evt;
+    auto consumer = launch(collect(producer(evt)));
+    REQUIRE(!consumer.ready());
+    evt.set_value(2);
+    REQUIRE(consumer.ready());
+    REQUIRE(join(consumer) == std::vector{ 1, 2, 3 });
+}
+
+
+TEST_CASE("Async generator: thread pool", "[Async generator]") {
+    static const auto square = [](int value) -> task<int> {
+        co_return value * value;
+    };
+    static const auto producer = [](thread_pool& pool, int count) -> async_generator<int> {
+        for (int i = 0; i < count; ++i) {
+            co_yield co_await launch(square(i), pool);
+        }
+    };
+    thread_pool pool(2);
+    const auto values = join(collect(producer(pool, 100)));
+    REQUIRE(values.size() == 100);
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(values[i] == i * i);
+    }
+}
+
+
+TEST_CASE("Async generator: exception", "[Async generator]") {
+    static const auto producer = []() -> async_generator<int> {
+        co_yield 1;
+        throw std::runtime_error("test");
+    };
+    REQUIRE_THROWS_AS(join(collect(producer())), std::runtime_error);
+}
+
+
+TEST_CASE("Async generator: stop token inherited", "[Async generator]") {
+    static const auto producer = [](event<int>& evt) -> async_generator<int> {
+        co_yield co_await evt;
+    };
+    static const auto consumer = [](event<int>& evt) -> task<void> {
+        auto g = producer(evt);
+        while (co_await g) {
+        }
+    };
+    event<int> evt;
+    std::stop_source source;
+    auto t = consumer(evt);
+    t.set_stop_token(source.get_token());
+    t.launch();
+    REQUIRE(!t.ready());
+    source.request_stop();
+    REQUIRE(t.ready());
+    REQUIRE_THROWS_AS(join(t), operation_cancelled);
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "monitor_task.hpp"
+
+#include <asyncpp/barrier.hpp>
+#include <asyncpp/join.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace asyncpp;
+
+
+template <class Barrier>
+monitor_task arrive_and_wait(Barrier& b) {
+    co_await b.arrive_and_wait();
+}
+
+
+TEST_CASE("Barrier: single phase", "[Barrier]") {
+    barrier b(2);
+    auto monitor1 = arrive_and_wait(b);
+    REQUIRE(!monitor1.get_counters().done);
+    auto monitor2 = arrive_and_wait(b);
+    REQUIRE(monitor1.get_counters().done);
+    REQUIRE(monitor2.get_counters().done);
+    REQUIRE(monitor2.get_counters().suspensions == 0);
+}
+
+
+TEST_CASE("Barrier: multiple phases", "[Barrier]") {
+    int completions = 0;
+    barrier b(2, std::function<void()>([&completions] { ++completions; }));
+    for (int i = 1; i <= 3; ++i) {
+        auto monitor1 = arrive_and_wait(b);
+        REQUIRE(!monitor1.get_counters().done);
+        REQUIRE(completions == i - 1);
+        auto monitor2 = arrive_and_wait(b);
+        REQUIRE(completions == i);
+        REQUIRE(monitor1.get_counters().done);
+        REQUIRE(monitor2.get_counters().done);
+    }
+}
+
+
+TEST_CASE("Barrier: arrive and drop", "[Barrier]") {
+    barrier b(3);
+    auto monitor1 = arrive_and_wait(b);
+    auto monitor2 = arrive_and_wait(b);
+    b.arrive_and_drop();
+    REQUIRE(monitor1.get_counters().done);
+    REQUIRE(monitor2.get_counters().done);
+
+    auto monitor3 = arrive_and_wait(b);
+    REQUIRE(!monitor3.get_counters().done);
+    auto monitor4 = arrive_and_wait(b);
+    REQUIRE(monitor3.get_counters().done);
+    REQUIRE(monitor4.get_counters().done);
+}
+
+
+TEST_CASE("Barrier: multiple threads", "[Barrier]") {
+    static constexpr int num_tasks = 16;
+    static constexpr int num_phases = 200;
+
+    struct completion {
+        std::atomic_int* arrived;
+        std::atomic_int* phases;
+        bool* valid;
+        void operator()() const noexcept {
+            if (arrived->load() != num_tasks * (phases->load() + 1)) {
+                *valid = false;
+            }
+            phases->fetch_add(1);
+        }
+    };
+
+    static const auto coro = [](barrier<completion>& b, std::atomic_int& arrived, std::atomic_int& phases) -> task<bool> {
+        bool valid = true;
+        for (int i = 0; i < num_phases; ++i) {
+            arrived.fetch_add(1);
+            co_await b.arrive_and_wait();
+            valid = valid && phases.load() == i + 1;
+        }
+        co_return valid;
+    };
+
+    thread_pool pool(4);
+    std::atomic_int arrived = 0;
+    std::atomic_int phases = 0;
+    bool valid = true;
+    barrier b(num_tasks, completion{ &arrived, &phases, &valid });
+    std::vector<task<bool>> tasks;
+    for (int i = 0; i < num_tasks; ++i) {
+        tasks.push_back(launch(coro(b, arrived, phases), pool));
+    }
+    for (auto& t : tasks) {
+        REQUIRE(join(t));
+    }
+    REQUIRE(valid);
+    REQUIRE(phases == num_phases);
+}
\ No newline at end of file
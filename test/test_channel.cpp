@@ -0,0 +1,225 @@
+#include <asyncpp/channel.hpp>
+#include <asyncpp/join.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+
+using namespace asyncpp;
+
+
+static task<void> send_all(channel<int>& ch, std::vector<int> values) {
+    for (const auto value : values) {
+        co_await ch.send(value);
+    }
+}
+
+
+static task<std::vector<int>> receive_all(channel<int>& ch) {
+    std::vector<int> values;
+    while (const auto value = co_await ch.receive()) {
+        values.push_back(*value);
+    }
+    co_return values;
+}
+
+
+TEST_CASE("Channel: try_send & try_receive", "[Channel]") {
+    SECTION("bounded") {
+        channel<int> ch(2);
+        REQUIRE(ch.capacity() == 2);
+        REQUIRE(ch.try_send(1));
+        REQUIRE(ch.try_send(2));
+        REQUIRE(!ch.try_send(3));
+        REQUIRE(ch.try_receive() == 1);
+        REQUIRE(ch.try_receive() == 2);
+        REQUIRE(!ch.try_receive());
+    }
+    SECTION("unbounded") {
+        channel<int> ch;
+        REQUIRE(ch.capacity() == channel<int>::unbounded);
+        for (int i = 0; i < 1000; ++i) {
+            REQUIRE(ch.try_send(i));
+        }
+        for (int i = 0; i < 1000; ++i) {
+            REQUIRE(ch.try_receive() == i);
+        }
+        REQUIRE(!ch.try_receive());
+    }
+    SECTION("move only") {
+        channel<std::unique_ptr<int>> ch(1);
+        REQUIRE(ch.try_send(std::make_unique<int>(3)));
+        const auto value = ch.try_receive();
+        REQUIRE(value);
+        REQUIRE(**value == 3);
+    }
+}
+
+
+TEST_CASE("Channel: receive waits for send", "[Channel]") {
+    channel<int> ch(1);
+    auto receiver = launch(receive_all(ch));
+    REQUIRE(!receiver.ready());
+    REQUIRE(ch.try_send(1));
+    REQUIRE(ch.try_send(2));
+    REQUIRE(!receiver.ready());
+    ch.close();
+    REQUIRE(join(receiver) == std::vector{ 1, 2 });
+}
+
+
+TEST_CASE("Channel: send waits for receive", "[Channel]") {
+    channel<int> ch(2);
+    auto sender = launch(send_all(ch, { 1, 2, 3, 4, 5 }));
+    REQUIRE(!sender.ready());
+    REQUIRE(ch.try_receive() == 1);
+    REQUIRE(!sender.ready());
+    REQUIRE(ch.try_receive() == 2);
+    REQUIRE(ch.try_receive() == 3);
+    REQUIRE(sender.ready());
+    REQUIRE(ch.try_receive() == 4);
+    REQUIRE(ch.try_receive() == 5);
+    REQUIRE(!ch.try_receive());
+}
+
+
+TEST_CASE("Channel: close", "[Channel]") {
+    SECTION("fails senders") {
+        static const auto coro = [](channel<int>& ch, int value) -> task<bool> {
+            co_return co_await ch.send(value);
+        };
+        channel<int> ch(1);
+        REQUIRE(ch.try_send(1));
+        auto sender = launch(coro(ch, 2));
+        REQUIRE(!sender.ready());
+        ch.close();
+        REQUIRE(ch.closed());
+        REQUIRE(join(sender) == false);
+        REQUIRE(!ch.try_send(3));
+        REQUIRE(ch.try_receive() == 1);
+        REQUIRE(!ch.try_receive());
+    }
+    SECTION("drains values") {
+        channel<int> ch;
+        REQUIRE(ch.try_send(1));
+        ch.close();
+        REQUIRE(join(receive_all(ch)) == std::vector{ 1 });
+    }
+}
+
+
+TEST_CASE("Channel: receive_many", "[Channel]") {
+    static const auto coro = [](channel<int>& ch, size_t max) -> task<std::vector<int>> {
+        co_return co_await ch.receive_many(max);
+    };
+    channel<int> ch(8);
+    SECTION("available") {
+        for (int i = 0; i < 5; ++i) {
+            REQUIRE(ch.try_send(i));
+        }
+        REQUIRE(join(coro(ch, 3)) == std::vector{ 0, 1, 2 });
+        REQUIRE(join(coro(ch, 3)) == std::vector{ 3, 4 });
+    }
+    SECTION("waiting") {
+        auto receiver = launch(coro(ch, 3));
+        REQUIRE(!receiver.ready());
+        REQUIRE(ch.try_send(7));
+        REQUIRE(join(receiver) == std::vector{ 7 });
+    }
+    SECTION("closed") {
+        ch.close();
+        REQUIRE(join(coro(ch, 3)).empty());
+    }
+}
+
+
+TEST_CASE("Channel: cancel", "[Channel]") {
+    SECTION("receive") {
+        static const auto coro = [](channel<int>& ch) -> task<void> {
+            co_await ch.receive();
+        };
+        channel<int> ch(1);
+        std::stop_source source;
+        auto t = coro(ch);
+        t.set_stop_token(source.get_token());
+        t.launch();
+        source.request_stop();
+        REQUIRE_THROWS_AS(join(t), operation_cancelled);
+        REQUIRE(ch.try_send(1));
+        REQUIRE(ch.try_receive() == 1);
+    }
+    SECTION("send") {
+        static const auto coro = [](channel<int>& ch) -> task<void> {
+            co_await ch.send(2);
+        };
+        channel<int> ch(1);
+        REQUIRE(ch.try_send(1));
+        std::stop_source source;
+        auto t = coro(ch);
+        t.set_stop_token(source.get_token());
+        t.launch();
+        source.request_stop();
+        REQUIRE_THROWS_AS(join(t), operation_cancelled);
+        REQUIRE(ch.try_receive() == 1);
+        REQUIRE(!ch.try_receive());
+    }
+}
+
+
+static void multiple_producers_consumers(size_t capacity) {
+    static constexpr int num_producers = 4;
+    static constexpr int num_consumers = 4;
+    static constexpr int num_values = 2000;
+    thread_pool pool(4);
+    channel<int> ch(capacity);
+
+    std::vector<task<void>> producers;
+    std::vector<task<std::vector<int>>> consumers;
+    for (int i = 0; i < num_consumers; ++i) {
+        consumers.push_back(launch(receive_all(ch), pool));
+    }
+    for (int i = 0; i < num_producers; ++i) {
+        std::vector<int> values(num_values);
+        std::iota(values.begin(), values.end(), i * num_values);
+        producers.push_back(launch(send_all(ch, std::move(values)), pool));
+    }
+    for (auto& producer : producers) {
+        join(producer);
+    }
+    ch.close();
+
+    std::vector<int> received;
+    for (auto& consumer : consumers) {
+        const auto values = join(consumer);
+        // Values from the same producer arrive in order.
+        for (int i = 0; i < num_producers; ++i) {
+            std::vector<int> from_producer;
+            std::ranges::copy_if(values, std::back_inserter(from_producer), [&](int v) { return v / num_values == i; });
+            REQUIRE(std::ranges::is_sorted(from_producer));
+        }
+        received.insert(received.end(), values.begin(), values.end());
+    }
+    std::ranges::sort(received);
+    std::vector<int> expected(num_producers * num_values);
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(received == expected);
+}
+
+
+TEST_CASE("Channel: multiple producers and consumers", "[Channel]") {
+    SECTION("capacity 1") {
+        multiple_producers_consumers(1);
+    }
+    SECTION("capacity 16") {
+        multiple_producers_consumers(16);
+    }
+    SECTION("unbounded") {
+        multiple_producers_consumers(channel<int>::unbounded);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include "monitor_task.hpp"
+
+#include <asyncpp/condition_variable.hpp>
+#include <asyncpp/join.hpp>
+#include <asyncpp/mutex.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace asyncpp;
+
+
+static monitor_task wait(mutex& mtx, condition_variable& cv) {
+    unique_lock lk(co_await mtx.exclusive());
+    co_await cv.wait(lk);
+    REQUIRE(mtx._debug_is_locked());
+}
+
+
+static monitor_task wait_for(mutex& mtx, condition_variable& cv, const bool& flag) {
+    unique_lock lk(co_await mtx.exclusive());
+    co_await cv.wait(lk, [&flag] { return flag; });
+    REQUIRE(flag);
+    REQUIRE(mtx._debug_is_locked());
+}
+
+
+TEST_CASE("Condition variable: wait", "[Condition variable]") {
+    mutex mtx;
+    condition_variable cv;
+
+    SECTION("unlocks while waiting") {
+        auto monitor = wait(mtx, cv);
+        REQUIRE(!monitor.get_counters().done);
+        REQUIRE(!mtx._debug_is_locked());
+        cv.notify_one();
+        REQUIRE(monitor.get_counters().done);
+        REQUIRE(!mtx._debug_is_locked());
+    }
+    SECTION("notify one") {
+        auto monitor1 = wait(mtx, cv);
+        auto monitor2 = wait(mtx, cv);
+        cv.notify_one();
+        REQUIRE(monitor1.get_counters().done);
+        REQUIRE(!monitor2.get_counters().done);
+        cv.notify_one();
+        REQUIRE(monitor2.get_counters().done);
+    }
+    SECTION("notify all") {
+        auto monitor1 = wait(mtx, cv);
+        auto monitor2 = wait(mtx, cv);
+        cv.notify_all();
+        REQUIRE(monitor1.get_counters().done);
+        REQUIRE(monitor2.get_counters().done);
+    }
+    SECTION("notify without waiting") {
+        cv.notify_one();
+        cv.notify_all();
+        auto monitor = wait(mtx, cv);
+        REQUIRE(!monitor.get_counters().done);
+        cv.notify_one();
+        REQUIRE(monitor.get_counters().done);
+    }
+}
+
+
+TEST_CASE("Condition variable: wait morphing", "[Condition variable]") {
+    mutex mtx;
+    condition_variable cv;
+
+    auto monitor1 = wait(mtx, cv);
+    auto monitor2 = wait(mtx, cv);
+    REQUIRE(mtx.try_lock());
+    cv.notify_all();
+    // The notified coroutines wait for the mutex without being resumed.
+    REQUIRE(monitor1.get_counters().suspensions == 0);
+    REQUIRE(monitor2.get_counters().suspensions == 0);
+    mtx.unlock();
+    REQUIRE(monitor1.get_counters().done);
+    REQUIRE(monitor2.get_counters().done);
+    REQUIRE(monitor1.get_counters().suspensions == 1);
+    REQUIRE(monitor2.get_counters().suspensions == 1);
+}
+
+
+TEST_CASE("Condition variable: predicate", "[Condition variable]") {
+    mutex mtx;
+    condition_variable cv;
+    bool flag = false;
+
+    SECTION("already true") {
+        flag = true;
+        auto monitor = wait_for(mtx, cv, flag);
+        REQUIRE(monitor.get_counters().done);
+        REQUIRE(monitor.get_counters().suspensions == 0);
+    }
+    SECTION("spurious notification") {
+        auto monitor = wait_for(mtx, cv, flag);
+        cv.notify_all();
+        REQUIRE(!monitor.get_counters().done);
+        REQUIRE(!mtx._debug_is_locked());
+        flag = true;
+        cv.notify_all();
+        REQUIRE(monitor.get_counters().done);
+    }
+}
+
+
+TEST_CASE("Condition variable: cancel waiting", "[Condition variable]") {
+    static const auto coro = [](mutex& mtx, condition_variable& cv) -> task<bool> {
+        unique_lock lk(co_await mtx.exclusive());
+        try {
+            co_await cv.wait(lk);
+        }
+        catch (operation_cancelled&) {
+            co_return mtx._debug_is_locked();
+        }
+        co_return false;
+    };
+    mutex mtx;
+    condition_variable cv;
+    std::stop_source source;
+
+    SECTION("while waiting") {
+        auto t = coro(mtx, cv);
+        t.set_stop_token(source.get_token());
+        t.launch();
+        REQUIRE(!t.ready());
+        source.request_stop();
+        REQUIRE(t.ready());
+        REQUIRE(join(t));
+    }
+    SECTION("while mutex is locked") {
+        auto t = coro(mtx, cv);
+        t.set_stop_token(source.get_token());
+        t.launch();
+        REQUIRE(mtx.try_lock());
+        source.request_stop();
+        REQUIRE(!t.ready());
+        mtx.unlock();
+        REQUIRE(t.ready());
+        REQUIRE(join(t));
+    }
+    SECTION("before waiting") {
+        source.request_stop();
+        auto t = coro(mtx, cv);
+        t.set_stop_token(source.get_token());
+        REQUIRE(join(t));
+    }
+    REQUIRE(!mtx._debug_is_locked());
+}
+
+
+TEST_CASE("Condition variable: cancel while notified", "[Condition variable]") {
+    static const auto cancellable = [](mutex& mtx, condition_variable& cv) -> task<bool> {
+        unique_lock lk(co_await mtx.exclusive());
+        try {
+            co_await cv.wait(lk);
+        }
+        catch (operation_cancelled&) {
+            co_return false;
+        }
+        co_return true;
+    };
+    static const auto predicate = [](mutex& mtx, condition_variable& cv, const bool& flag) -> task<bool> {
+        unique_lock lk(co_await mtx.exclusive());
+        try {
+            co_await cv.wait(lk, [&flag] { return flag; });
+        }
+        catch (operation_cancelled&) {
+            co_return false;
+        }
+        co_return true;
+    };
+
+    SECTION("notification") {
+        mutex mtx;
+        condition_variable cv;
+        std::stop_source source;
+        auto first = cancellable(mtx, cv);
+        first.set_stop_token(source.get_token());
+        first.launch();
+        auto second = launch(cancellable(mtx, cv));
+        REQUIRE(mtx.try_lock());
+        cv.notify_one();
+        source.request_stop();
+        mtx.unlock();
+        REQUIRE(first.ready());
+        REQUIRE(join(first));
+        REQUIRE(!second.ready());
+        cv.notify_one();
+        REQUIRE(join(second));
+    }
+    SECTION("satisfied predicate") {
+        mutex mtx;
+        condition_variable cv;
+        std::stop_source source;
+        bool flag = false;
+        auto t = predicate(mtx, cv, flag);
+        t.set_stop_token(source.get_token());
+        t.launch();
+        REQUIRE(mtx.try_lock());
+        flag = true;
+        cv.notify_one();
+        source.request_stop();
+        mtx.unlock();
+        REQUIRE(t.ready());
+        REQUIRE(join(t));
+    }
+    SECTION("multiple threads") {
+        // The notification goes to the first waiter, so the second one is only notified if the first one was cancelled.
+        for (int iteration = 0; iteration < 1000; ++iteration) {
+            mutex mtx;
+            condition_variable cv;
+            std::stop_source source;
+            auto first = cancellable(mtx, cv);
+            first.set_stop_token(source.get_token());
+            first.launch();
+            auto second = launch(cancellable(mtx, cv));
+
+            std::jthread stopper([&source] { source.request_stop(); });
+            std::jthread notifier([&cv] { cv.notify_one(); });
+            stopper.join();
+            notifier.join();
+
+            REQUIRE(first.ready());
+            const auto notified = join(first);
+            REQUIRE(second.ready() == !notified);
+            cv.notify_all();
+            REQUIRE(join(second));
+        }
+    }
+}
+
+
+TEST_CASE("Condition variable: multiple threads", "[Condition variable]") {
+    static constexpr int num_tasks = 8;
+    static constexpr int num_items = 500;
+    static constexpr size_t capacity = 4;
+
+    struct buffer {
+        mutex mtx;
+        condition_variable not_full;
+        condition_variable not_empty;
+        std::deque<int> items;
+    };
+
+    static const auto produce = [](buffer& buf) -> task<void> {
+        for (int i = 0; i < num_items; ++i) {
+            unique_lock lk(co_await buf.mtx.exclusive());
+            co_await buf.not_full.wait(lk, [&buf] { return buf.items.size() < capacity; });
+            buf.items.push_back(1);
+            buf.not_empty.notify_one();
+        }
+    };
+    static const auto consume = [](buffer& buf) -> task<int> {
+        int sum = 0;
+        for (int i = 0; i < num_items; ++i) {
+            unique_lock lk(co_await buf.mtx.exclusive());
+            co_await buf.not_empty.wait(lk, [&buf] { return !buf.items.empty(); });
+            sum += buf.items.front();
+            buf.items.pop_front();
+            buf.not_full.notify_one();
+        }
+        co_return sum;
+    };
+
+    thread_pool pool(4);
+    buffer buf;
+    std::vector<task<void>> producers;
+    std::vector<task<int>> consumers;
+    for (int i = 0; i < num_tasks; ++i) {
+        producers.push_back(launch(produce(buf), pool));
+        consumers.push_back(launch(consume(buf), pool));
+    }
+    int sum = 0;
+    for (auto& t : producers) {
+        join(t);
+    }
+    for (auto& t : consumers) {
+        sum += join(t);
+    }
+    REQUIRE(sum == num_tasks * num_items);
+    REQUIRE(buf.items.empty());
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "monitor_task.hpp"
+
+#include <asyncpp/distributed_shared_mutex.hpp>
+#include <asyncpp/join.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace asyncpp;
+
+
+static monitor_task lock_exclusively(distributed_shared_mutex& mtx) {
+    co_await mtx.exclusive();
+}
+
+
+static monitor_task lock_shared(distributed_shared_mutex& mtx) {
+    co_await mtx.shared();
+}
+
+
+TEST_CASE("Distributed shared mutex: try lock", "[Distributed shared mutex]") {
+    distributed_shared_mutex mtx(4);
+
+    SECTION("exclusive") {
+        REQUIRE(mtx.try_lock());
+        REQUIRE(mtx._debug_is_exclusive_locked());
+        REQUIRE(!mtx.try_lock());
+        REQUIRE(!mtx.try_lock_shared());
+        mtx.unlock();
+    }
+    SECTION("shared") {
+        REQUIRE(mtx.try_lock_shared());
+        REQUIRE(mtx.try_lock_shared());
+        REQUIRE(mtx._debug_is_shared_locked() == 2);
+        REQUIRE(!mtx.try_lock());
+        mtx.unlock_shared();
+        mtx.unlock_shared();
+        REQUIRE(mtx.try_lock());
+        mtx.unlock();
+    }
+}
+
+
+TEST_CASE("Distributed shared mutex: writer waits for readers", "[Distributed shared mutex]") {
+    distributed_shared_mutex mtx(4);
+    REQUIRE(mtx.try_lock_shared());
+    REQUIRE(mtx.try_lock_shared());
+    auto writer = lock_exclusively(mtx);
+    REQUIRE(!writer.get_counters().done);
+    // Readers don't join while the writer waits.
+    REQUIRE(!mtx.try_lock_shared());
+    mtx.unlock_shared();
+    REQUIRE(!writer.get_counters().done);
+    mtx.unlock_shared();
+    REQUIRE(writer.get_counters().done);
+    REQUIRE(mtx._debug_is_exclusive_locked());
+    mtx.unlock();
+    REQUIRE(!mtx._debug_is_exclusive_locked());
+}
+
+
+TEST_CASE("Distributed shared mutex: readers and writers alternate", "[Distributed shared mutex]") {
+    distributed_shared_mutex mtx(4);
+    REQUIRE(mtx.try_lock());
+    auto writer1 = lock_exclusively(mtx);
+    auto reader1 = lock_shared(mtx);
+    auto reader2 = lock_shared(mtx);
+    auto writer2 = lock_exclusively(mtx);
+    REQUIRE(!reader1.get_counters().done);
+    REQUIRE(!writer1.get_counters().done);
+
+    mtx.unlock();
+    REQUIRE(reader1.get_counters().done);
+    REQUIRE(reader2.get_counters().done);
+    REQUIRE(!writer1.get_counters().done);
+    REQUIRE(mtx._debug_is_shared_locked() == 2);
+
+    mtx.unlock_shared();
+    mtx.unlock_shared();
+    REQUIRE(writer1.get_counters().done);
+    REQUIRE(!writer2.get_counters().done);
+
+    mtx.unlock();
+    REQUIRE(writer2.get_counters().done);
+    mtx.unlock();
+}
+
+
+TEST_CASE("Distributed shared mutex: lock wrappers", "[Distributed shared mutex]") {
+    distributed_shared_mutex mtx;
+    auto monitor = [](distributed_shared_mutex& mtx) -> monitor_task {
+        {
+            unique_lock lk(co_await mtx.exclusive());
+            REQUIRE(mtx._debug_is_exclusive_locked());
+        }
+        {
+            shared_lock lk(co_await mtx.shared());
+            REQUIRE(mtx._debug_is_shared_locked() == 1);
+        }
+    }(mtx);
+    REQUIRE(monitor.get_counters().done);
+    REQUIRE(!mtx._debug_is_exclusive_locked());
+    REQUIRE(mtx._debug_is_shared_locked() == 0);
+}
+
+
+TEST_CASE("Distributed shared mutex: multiple threads", "[Distributed shared mutex]") {
+    static constexpr int num_tasks = 16;
+    static constexpr int num_iterations = 500;
+    static const auto coro = [](distributed_shared_mutex& mtx, int& value, int index) -> task<void> {
+        for (int i = 0; i < num_iterations; ++i) {
+            if ((i + index) % 8 == 0) {
+                unique_lock lk(co_await mtx.exclusive());
+                ++value;
+            }
+            else {
+                shared_lock lk(co_await mtx.shared());
+                [[maybe_unused]] volatile int read = value;
+            }
+        }
+    };
+
+    thread_pool pool(4);
+    distributed_shared_mutex mtx(4);
+    int value = 0;
+    std::vector<task<void>> tasks;
+    for (int i = 0; i < num_tasks; ++i) {
+        tasks.push_back(launch(coro(mtx, value, i), pool));
+    }
+    for (auto& t : tasks) {
+        join(t);
+    }
+    REQUIRE(value == num_tasks * num_iterations / 8);
+    REQUIRE(mtx._debug_is_shared_locked() == 0);
+}
\ No newline at end of file
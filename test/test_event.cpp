@@ -2,8 +2,13 @@
 #include "monitor_task.hpp"
 
 #include <asyncpp/event.hpp>
+#include <asyncpp/join.hpp>
 #include <asyncpp/task.hpp>
 #include <asyncpp/testing/interleaver.hpp>
+#include <asyncpp/thread_pool.hpp>
+
+#include <atomic>
+#include <vector>
 
 #include <catch2/catch_template_test_macros.hpp>
 #include <catch2/catch_test_macros.hpp>
@@ -207,4 +212,177 @@ TEMPLATE_TEST_CASE("Event: await-set interleave", "[Event]", event<int>, broadca
     };
 
     INTERLEAVED_RUN(scenario, THREAD("t1", &scenario::thread_1), THREAD("t2", &scenario::thread_2));
+}
+
+
+TEST_CASE("Event: cancel await", "[Event]") {
+    static const auto coro = [](event<int>& evt) -> task<int> {
+        co_return co_await evt;
+    };
+    event<int> evt;
+    std::stop_source source;
+    auto t = coro(evt);
+    t.set_stop_token(source.get_token());
+    t.launch();
+    REQUIRE(!t.ready());
+    source.request_stop();
+    REQUIRE(t.ready());
+    REQUIRE_THROWS_AS(join(t), operation_cancelled);
+    evt.set_value(1);
+}
+
+
+TEST_CASE("Event: cancel after set", "[Event]") {
+    static const auto coro = [](event<int>& evt) -> task<int> {
+        co_return co_await evt;
+    };
+    event<int> evt;
+    std::stop_source source;
+    auto t = coro(evt);
+    t.set_stop_token(source.get_token());
+    t.launch();
+    evt.set_value(1);
+    source.request_stop();
+    REQUIRE(join(t) == 1);
+}
+
+
+TEST_CASE("Event: manual reset", "[Event]") {
+    manual_reset_event evt;
+
+    SECTION("set and reset") {
+        REQUIRE(!evt.is_set());
+        evt.set();
+        REQUIRE(evt.is_set());
+        evt.set();
+        REQUIRE(evt.is_set());
+        evt.reset();
+        REQUIRE(!evt.is_set());
+        evt.reset();
+        REQUIRE(!evt.is_set());
+    }
+    SECTION("initially set") {
+        manual_reset_event set_evt(true);
+        REQUIRE(set_evt.is_set());
+        auto monitor = monitor_coro(set_evt);
+        REQUIRE(monitor.get_counters().done);
+        REQUIRE(monitor.get_counters().suspensions == 0);
+    }
+    SECTION("resumes all awaiters") {
+        auto mon1 = monitor_coro(evt);
+        auto mon2 = monitor_coro(evt);
+        REQUIRE(!mon1.get_counters().done);
+        REQUIRE(!mon2.get_counters().done);
+        evt.set();
+        REQUIRE(mon1.get_counters().done);
+        REQUIRE(mon2.get_counters().done);
+        auto mon3 = monitor_coro(evt);
+        REQUIRE(mon3.get_counters().done);
+        REQUIRE(mon3.get_counters().suspensions == 0);
+    }
+    SECTION("reuse after reset") {
+        evt.set();
+        evt.reset();
+        auto monitor = monitor_coro(evt);
+        REQUIRE(!monitor.get_counters().done);
+        evt.set();
+        REQUIRE(monitor.get_counters().done);
+    }
+}
+
+
+TEST_CASE("Event: auto reset", "[Event]") {
+    auto_reset_event evt;
+
+    SECTION("set and reset") {
+        REQUIRE(!evt.is_set());
+        evt.set();
+        REQUIRE(evt.is_set());
+        evt.reset();
+        REQUIRE(!evt.is_set());
+    }
+    SECTION("await set") {
+        evt.set();
+        evt.set();
+        auto mon1 = monitor_coro(evt);
+        REQUIRE(mon1.get_counters().done);
+        REQUIRE(!evt.is_set());
+        auto mon2 = monitor_coro(evt);
+        REQUIRE(!mon2.get_counters().done);
+        evt.set();
+        REQUIRE(mon2.get_counters().done);
+    }
+    SECTION("resumes one awaiter") {
+        auto mon1 = monitor_coro(evt);
+        auto mon2 = monitor_coro(evt);
+        evt.set();
+        REQUIRE(mon1.get_counters().done);
+        REQUIRE(!mon2.get_counters().done);
+        REQUIRE(!evt.is_set());
+        evt.set();
+        REQUIRE(mon2.get_counters().done);
+        REQUIRE(!evt.is_set());
+    }
+}
+
+
+TEST_CASE("Event: auto reset cancel await", "[Event]") {
+    static const auto coro = [](auto_reset_event& evt) -> task<void> {
+        co_await evt;
+    };
+    auto_reset_event evt;
+    std::stop_source source;
+    auto t1 = coro(evt);
+    auto t2 = coro(evt);
+    t1.set_stop_token(source.get_token());
+    t1.launch();
+    t2.launch();
+    source.request_stop();
+    REQUIRE(t1.ready());
+    REQUIRE_THROWS_AS(join(t1), operation_cancelled);
+    REQUIRE(!t2.ready());
+    evt.set();
+    REQUIRE(t2.ready());
+    join(t2);
+    evt.set();
+    REQUIRE(evt.is_set());
+}
+
+
+TEMPLATE_TEST_CASE("Event: reset event multiple threads", "[Event]", manual_reset_event, auto_reset_event) {
+    static constexpr int num_producers = 4;
+    static constexpr int num_signals = 1000;
+
+    static const auto produce = [](TestType& evt, std::atomic_int& counter) -> task<void> {
+        for (int i = 0; i < num_signals; ++i) {
+            counter.fetch_add(1);
+            evt.set();
+        }
+        co_return;
+    };
+    static const auto consume = [](TestType& evt, std::atomic_int& counter) -> task<void> {
+        while (true) {
+            if constexpr (std::is_same_v<TestType, manual_reset_event>) {
+                evt.reset();
+            }
+            if (counter.load() == num_producers * num_signals) {
+                break;
+            }
+            co_await evt;
+        }
+    };
+
+    thread_pool pool(4);
+    TestType evt;
+    std::atomic_int counter = 0;
+    auto consumer = launch(consume(evt, counter), pool);
+    std::vector<task<void>> producers;
+    for (int i = 0; i < num_producers; ++i) {
+        producers.push_back(launch(produce(evt, counter), pool));
+    }
+    for (auto& t : producers) {
+        join(t);
+    }
+    join(consumer);
+    REQUIRE(counter == num_producers * num_signals);
 }
\ No newline at end of file
@@ -1,5 +1,11 @@
 #include <asyncpp/generator.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include <catch2/catch_test_macros.hpp>
@@ -136,4 +142,154 @@ TEST_CASE("Generator: move assign", "[Generator]") {
     REQUIRE(*it == 1);
     ++it;
     REQUIRE(it == m.end());
+}
+
+struct tree_node {
+    int value;
+    std::unique_ptr<tree_node> left;
+    std::unique_ptr<tree_node> right;
+};
+
+
+static generator<int> walk(const tree_node* node) {
+    if (node) {
+        co_yield elements_of(walk(node->left.get()));
+        co_yield node->value;
+        co_yield elements_of(walk(node->right.get()));
+    }
+}
+
+
+static generator<int> countdown(int depth) {
+    co_yield depth;
+    if (depth > 0) {
+        co_yield elements_of(countdown(depth - 1));
+    }
+}
+
+
+TEST_CASE("Generator: elements_of", "[Generator]") {
+    SECTION("tree") {
+        tree_node root{ 4 };
+        root.left = std::make_unique<tree_node>(tree_node{ 2 });
+        root.left->left = std::make_unique<tree_node>(tree_node{ 1 });
+        root.left->right = std::make_unique<tree_node>(tree_node{ 3 });
+        root.right = std::make_unique<tree_node>(tree_node{ 5 });
+        const auto g = walk(&root);
+        std::vector<int> values{ begin(g), end(g) };
+        REQUIRE(values == std::vector{ 1, 2, 3, 4, 5 });
+    }
+    SECTION("deep") {
+        const auto g = countdown(1000);
+        std::vector<int> values{ begin(g), end(g) };
+        REQUIRE(values.size() == 1001);
+        REQUIRE(values.front() == 1000);
+        REQUIRE(values.back() == 0);
+    }
+    SECTION("empty") {
+        static const auto empty = []() -> generator<int> {
+            co_return;
+        };
+        static const auto coro = []() -> generator<int> {
+            co_yield elements_of(empty());
+            co_yield 1;
+            co_yield elements_of(empty());
+        };
+        const auto g = coro();
+        std::vector<int> values{ begin(g), end(g) };
+        REQUIRE(values == std::vector{ 1 });
+    }
+    SECTION("exception") {
+        static const auto failing = []() -> generator<int> {
+            co_yield 1;
+            throw std::runtime_error("test");
+        };
+        static const auto coro = []() -> generator<int> {
+            co_yield 0;
+            co_yield elements_of(failing());
+            co_yield 2;
+        };
+        const auto g = coro();
+        auto it = g.begin();
+        REQUIRE(*it == 0);
+        ++it;
+        REQUIRE(*it == 1);
+        ++it;
+        REQUIRE_THROWS_AS(*it, std::runtime_error);
+    }
+    SECTION("abandon") {
+        const auto g = countdown(10);
+        auto it = g.begin();
+        for (int i = 0; i < 5; ++i) {
+            ++it;
+        }
+        REQUIRE(*it == 5);
+    }
+}
+
+struct copy_counter {
+    int value = 0;
+    std::shared_ptr<int> copies = std::make_shared<int>(0);
+
+    copy_counter(int value) : value(value) {}
+    copy_counter(const copy_counter& other) : value(other.value), copies(other.copies) { ++*copies; }
+    copy_counter(copy_counter&&) noexcept = default;
+    copy_counter& operator=(const copy_counter&) = delete;
+    copy_counter& operator=(copy_counter&&) noexcept = default;
+};
+
+
+TEST_CASE("Generator: yielded objects", "[Generator]") {
+    SECTION("temporaries are not copied") {
+        const auto copies = std::make_shared<int>(0);
+        static const auto coro = [](std::shared_ptr<int> copies) -> generator<copy_counter> {
+            copy_counter item(1);
+            item.copies = copies;
+            co_yield std::move(item);
+        };
+        const auto g = coro(copies);
+        REQUIRE((*g.begin()).value == 1);
+        REQUIRE(*copies == 0);
+    }
+    SECTION("lvalues are copied") {
+        static const auto coro = [](copy_counter& item) -> generator<copy_counter> {
+            co_yield item;
+        };
+        copy_counter item(1);
+        const auto g = coro(item);
+        auto it = g.begin();
+        (*it).value = 2;
+        REQUIRE(*item.copies == 1);
+        REQUIRE(item.value == 1);
+    }
+    SECTION("const references are not copied") {
+        static const auto coro = [](const copy_counter& item) -> generator<const copy_counter&> {
+            co_yield item;
+        };
+        copy_counter item(1);
+        const auto g = coro(item);
+        REQUIRE(&*g.begin() == &item);
+        REQUIRE(*item.copies == 0);
+    }
+}
+
+
+TEST_CASE("Generator: ranges", "[Generator]") {
+    static const auto coro = [](int count) -> generator<int> {
+        for (int i = 0; i < count; ++i) {
+            co_yield i;
+        }
+    };
+    static_assert(std::ranges::input_range<generator<int>>);
+    static_assert(std::ranges::view<generator<int>>);
+    static_assert(std::ranges::view<generator<const std::string&>>);
+    static_assert(!std::ranges::borrowed_range<generator<int>>);
+
+    auto view = coro(100)
+                | std::views::filter([](int value) { return value % 2 == 0; })
+                | std::views::transform([](int value) { return value * value; })
+                | std::views::take(3);
+    std::vector<int> values;
+    std::ranges::copy(view, std::back_inserter(values));
+    REQUIRE(values == std::vector{ 0, 4, 16 });
 }
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "helper_schedulers.hpp"
+#include "monitor_allocator.hpp"
+
+#include <asyncpp/event.hpp>
+#include <asyncpp/inline_task.hpp>
+#include <asyncpp/join.hpp>
+#include <asyncpp/task.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+
+using namespace asyncpp;
+
+
+TEST_CASE("Inline task: valid", "[Inline task]") {
+    SECTION("empty") {
+        inline_task<void> t;
+        REQUIRE(!t.valid());
+    }
+    SECTION("valid") {
+        auto t = []() -> inline_task<void> { co_return; }();
+        REQUIRE(t.valid());
+        REQUIRE(!t.ready());
+    }
+}
+
+
+TEST_CASE("Inline task: co_await value", "[Inline task]") {
+    static const auto coro = [](int value) -> inline_task<int> {
+        co_return value;
+    };
+    static const auto enclosing = [](int value) -> task<int> {
+        co_return co_await coro(value);
+    };
+    REQUIRE(join(enclosing(42)) == 42);
+}
+
+
+TEST_CASE("Inline task: co_await ref", "[Inline task]") {
+    static int value = 42;
+    static const auto coro = [](int& value) -> inline_task<int&> {
+        co_return value;
+    };
+    static const auto enclosing = [](int& value) -> task<int&> {
+        co_return co_await coro(value);
+    };
+    auto task = enclosing(value);
+    auto& result = join(task);
+    REQUIRE(&result == &value);
+}
+
+
+TEST_CASE("Inline task: co_await moveable", "[Inline task]") {
+    static const auto coro = [](std::unique_ptr<int> value) -> inline_task<std::unique_ptr<int>> {
+        co_return value;
+    };
+    auto result = join(coro(std::make_unique<int>(42)));
+    REQUIRE(*result == 42);
+}
+
+
+TEST_CASE("Inline task: co_await exception", "[Inline task]") {
+    static const auto coro = []() -> inline_task<void> {
+        throw std::runtime_error("test");
+        co_return; // This statement is necessary!
+    };
+    static const auto enclosing = []() -> task<void> {
+        REQUIRE_THROWS_AS(co_await coro(), std::runtime_error);
+    };
+    join(enclosing());
+}
+
+
+TEST_CASE("Inline task: nested chain", "[Inline task]") {
+    struct chain {
+        static inline_task<int> link(int depth) {
+            if (depth == 0) {
+                co_return 0;
+            }
+            co_return 1 + co_await link(depth - 1);
+        }
+    };
+    REQUIRE(join(chain::link(100)) == 100);
+}
+
+
+TEST_CASE("Inline task: inherits awaiter's scheduler", "[Inline task]") {
+    thread_locked_scheduler sched;
+    event<int> evt;
+
+    static const auto coro = [](event<int>& evt) -> inline_task<int> {
+        co_return co_await evt;
+    };
+    static const auto enclosing = [](event<int>& evt) -> task<int> {
+        co_return co_await coro(evt);
+    };
+
+    auto t = launch(enclosing(evt), sched);
+    sched.resume();
+    REQUIRE(!t.ready());
+    evt.set_value(42);
+    REQUIRE(!t.ready());
+    sched.resume();
+    REQUIRE(t.ready());
+    REQUIRE(join(t) == 42);
+}
+
+
+TEST_CASE("Inline task: allocator", "[Inline task]") {
+    // The frame is allocated before the body runs, and the task escapes into join, so it can't be elided.
+    static const auto coro = [](std::allocator_arg_t, monitor_allocator<>& alloc) -> inline_task<size_t> {
+        co_return alloc.get_num_allocations();
+    };
+    monitor_allocator<> alloc;
+    {
+        auto t = coro(std::allocator_arg, alloc);
+        REQUIRE(join(t) == 1);
+    }
+    REQUIRE(alloc.get_num_allocations() == 1);
+    REQUIRE(alloc.get_num_live_objects() == 0);
+}
\ No newline at end of file
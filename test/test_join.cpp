@@ -1,5 +1,8 @@
 #include <asyncpp/join.hpp>
 #include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+
+#include <memory>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -53,4 +56,36 @@ TEST_CASE("Join: exception", "[Join]") {
 
     auto t = coro();
     REQUIRE_THROWS_AS(join(t), std::runtime_error);
+}
+
+
+TEST_CASE("Join: movable", "[Join]") {
+    static const auto coro = [](int value) -> task<std::unique_ptr<int>> {
+        co_return std::make_unique<int>(value);
+    };
+
+    auto t = coro(1);
+    const auto result = join(t);
+    REQUIRE(*result == 1);
+}
+
+
+TEST_CASE("Join: other thread", "[Join]") {
+    static const auto coro = [](int value) -> task<int> {
+        co_return value;
+    };
+
+    thread_pool pool(2);
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(join(launch(coro(i), pool)) == i);
+    }
+}
+
+
+TEST_CASE("Join: sync_wait", "[Join]") {
+    static const auto coro = [](int value) -> task<int> {
+        co_return value;
+    };
+
+    REQUIRE(sync_wait(coro(1)) == 1);
 }
\ No newline at end of file
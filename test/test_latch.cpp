@@ -0,0 +1,112 @@
+#include "monitor_task.hpp"
+
+#include <asyncpp/join.hpp>
+#include <asyncpp/latch.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+
+#include <atomic>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace asyncpp;
+
+
+static monitor_task wait(latch& l) {
+    co_await l;
+}
+
+
+TEST_CASE("Latch: count down", "[Latch]") {
+    SECTION("zero") {
+        latch l(0);
+        REQUIRE(l.try_wait());
+        auto monitor = wait(l);
+        REQUIRE(monitor.get_counters().done);
+    }
+    SECTION("single") {
+        latch l(1);
+        REQUIRE(!l.try_wait());
+        l.count_down();
+        REQUIRE(l.try_wait());
+    }
+    SECTION("multiple") {
+        latch l(3);
+        l.count_down(2);
+        REQUIRE(!l.try_wait());
+        l.count_down();
+        REQUIRE(l.try_wait());
+    }
+    SECTION("zero when ready") {
+        latch l(0);
+        l.count_down(0);
+        REQUIRE(l.try_wait());
+        l.count_down(0);
+        REQUIRE(l.try_wait());
+    }
+    SECTION("zero when not ready") {
+        latch l(1);
+        l.count_down(0);
+        REQUIRE(!l.try_wait());
+        l.count_down();
+        l.count_down(0);
+        REQUIRE(l.try_wait());
+    }
+}
+
+
+TEST_CASE("Latch: wait", "[Latch]") {
+    latch l(2);
+    auto monitor1 = wait(l);
+    auto monitor2 = wait(l);
+    l.count_down();
+    REQUIRE(!monitor1.get_counters().done);
+    REQUIRE(!monitor2.get_counters().done);
+    l.count_down();
+    REQUIRE(monitor1.get_counters().done);
+    REQUIRE(monitor2.get_counters().done);
+    auto monitor3 = wait(l);
+    REQUIRE(monitor3.get_counters().done);
+    REQUIRE(monitor3.get_counters().suspensions == 0);
+}
+
+
+TEST_CASE("Latch: arrive and wait", "[Latch]") {
+    static const auto coro = [](latch& l) -> monitor_task {
+        co_await l.arrive_and_wait();
+    };
+    latch l(2);
+    auto monitor1 = coro(l);
+    REQUIRE(!monitor1.get_counters().done);
+    auto monitor2 = coro(l);
+    REQUIRE(monitor1.get_counters().done);
+    REQUIRE(monitor2.get_counters().done);
+
+    static const auto coro_zero = [](latch& l) -> monitor_task {
+        co_await l.arrive_and_wait(0);
+    };
+    auto monitor3 = coro_zero(l);
+    REQUIRE(monitor3.get_counters().done);
+}
+
+
+TEST_CASE("Latch: multiple threads", "[Latch]") {
+    static constexpr int num_tasks = 64;
+    static const auto coro = [](latch& l, std::atomic_int& arrived) -> task<int> {
+        arrived.fetch_add(1);
+        co_await l.arrive_and_wait();
+        co_return arrived.load();
+    };
+
+    thread_pool pool(4);
+    latch l(num_tasks);
+    std::atomic_int arrived = 0;
+    std::vector<task<int>> tasks;
+    for (int i = 0; i < num_tasks; ++i) {
+        tasks.push_back(launch(coro(l, arrived), pool));
+    }
+    for (auto& t : tasks) {
+        REQUIRE(join(t) == num_tasks);
+    }
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "monitor_task.hpp"
 
+#include <asyncpp/join.hpp>
 #include <asyncpp/mutex.hpp>
+#include <asyncpp/task.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -206,4 +208,56 @@ TEST_CASE("Mutex: unique lock move assign", "[Mutex]") {
 
     REQUIRE(!mtx1._debug_is_locked());
     REQUIRE(!mtx2._debug_is_locked());
+}
+
+
+TEST_CASE("Mutex: cancel waiting", "[Mutex]") {
+    static const auto coro = [](mutex& mtx) -> task<void> {
+        co_await mtx.exclusive();
+        mtx.unlock();
+    };
+    mutex mtx;
+    std::stop_source source;
+    REQUIRE(mtx.try_lock());
+
+    auto t1 = coro(mtx);
+    auto t2 = coro(mtx);
+    t1.set_stop_token(source.get_token());
+    t1.launch();
+    t2.launch();
+    REQUIRE(!t1.ready());
+    source.request_stop();
+    REQUIRE(t1.ready());
+    REQUIRE_THROWS_AS(join(t1), operation_cancelled);
+
+    REQUIRE(!t2.ready());
+    mtx.unlock();
+    REQUIRE(t2.ready());
+    join(t2);
+    REQUIRE(!mtx._debug_is_locked());
+}
+
+
+TEST_CASE("Mutex: cancel before waiting", "[Mutex]") {
+    static const auto coro = [](mutex& mtx) -> task<void> {
+        co_await mtx.exclusive();
+        mtx.unlock();
+    };
+    mutex mtx;
+    std::stop_source source;
+    source.request_stop();
+
+    SECTION("locked") {
+        REQUIRE(mtx.try_lock());
+        auto t = coro(mtx);
+        t.set_stop_token(source.get_token());
+        REQUIRE_THROWS_AS(join(t), operation_cancelled);
+        mtx.unlock();
+    }
+    SECTION("unlocked") {
+        auto t = coro(mtx);
+        t.set_stop_token(source.get_token());
+        join(t);
+    }
+    REQUIRE(!mtx._debug_is_locked());
 }
\ No newline at end of file
@@ -1,6 +1,13 @@
 #include "monitor_task.hpp"
 
+#include <asyncpp/join.hpp>
 #include <asyncpp/semaphore.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -101,3 +108,197 @@ TEST_CASE("Semaphore - release", "[Semaphore]") {
     REQUIRE(monitor1.get_counters().done);
     REQUIRE(monitor2.get_counters().done);
 }
+
+
+TEST_CASE("Semaphore - cancel waiting", "[Semaphore]") {
+    static const auto coro = [](counting_semaphore& sema) -> task<void> {
+        co_await sema;
+    };
+    counting_semaphore sema(0);
+    std::stop_source source;
+
+    auto t1 = coro(sema);
+    auto t2 = coro(sema);
+    t1.set_stop_token(source.get_token());
+    t1.launch();
+    t2.launch();
+    source.request_stop();
+    REQUIRE(t1.ready());
+    REQUIRE_THROWS_AS(join(t1), operation_cancelled);
+
+    REQUIRE(!t2.ready());
+    sema.release();
+    REQUIRE(t2.ready());
+    REQUIRE(sema._debug_get_awaiters().empty());
+    REQUIRE(sema._debug_get_counter() == 0);
+}
+
+TEST_CASE("Semaphore - release up to max", "[Semaphore]") {
+    counting_semaphore sema(0, 2);
+    sema.release();
+    sema.release();
+    REQUIRE(sema._debug_get_counter() == 2);
+    REQUIRE(sema.try_acquire());
+    REQUIRE(sema.try_acquire());
+    REQUIRE(!sema.try_acquire());
+}
+
+
+TEST_CASE("Semaphore - multiple threads", "[Semaphore]") {
+    static constexpr int num_tasks = 64;
+    static constexpr int num_iterations = 200;
+    static constexpr ptrdiff_t limit = 3;
+    static const auto coro = [](counting_semaphore& sema, std::atomic_int& inside, std::atomic_int& max_inside) -> task<void> {
+        for (int i = 0; i < num_iterations; ++i) {
+            co_await sema;
+            const auto count = ++inside;
+            int expected = max_inside.load();
+            while (expected < count && !max_inside.compare_exchange_weak(expected, count)) {
+            }
+            --inside;
+            sema.release();
+        }
+    };
+
+    thread_pool pool(4);
+    counting_semaphore sema(limit, limit);
+    std::atomic_int inside = 0;
+    std::atomic_int max_inside = 0;
+    std::vector<task<void>> tasks;
+    for (int i = 0; i < num_tasks; ++i) {
+        tasks.push_back(launch(coro(sema, inside, max_inside), pool));
+    }
+    for (auto& t : tasks) {
+        join(t);
+    }
+    REQUIRE(max_inside <= limit);
+    REQUIRE(sema._debug_get_counter() == limit);
+    REQUIRE(sema._debug_get_awaiters().empty());
+}
+
+TEST_CASE("Semaphore - multiple units", "[Semaphore]") {
+    static const auto coro = [](counting_semaphore& sema, ptrdiff_t count) -> monitor_task {
+        co_await sema.acquire(count);
+    };
+
+    SECTION("try_acquire") {
+        counting_semaphore sema(5);
+        REQUIRE(sema.try_acquire(3));
+        REQUIRE(!sema.try_acquire(3));
+        REQUIRE(sema.try_acquire(2));
+        REQUIRE(sema._debug_get_counter() == 0);
+    }
+    SECTION("immediate") {
+        counting_semaphore sema(5);
+        auto monitor = coro(sema, 4);
+        REQUIRE(monitor.get_counters().done);
+        REQUIRE(sema._debug_get_counter() == 1);
+    }
+    SECTION("release wakes covered awaiters") {
+        counting_semaphore sema(1);
+        auto monitor1 = coro(sema, 2);
+        auto monitor2 = coro(sema, 3);
+        auto monitor3 = coro(sema, 2);
+        REQUIRE(!monitor1.get_counters().done);
+        sema.release(5);
+        REQUIRE(monitor1.get_counters().done);
+        REQUIRE(monitor2.get_counters().done);
+        REQUIRE(!monitor3.get_counters().done);
+        REQUIRE(sema._debug_get_counter() == 1);
+        sema.release(1);
+        REQUIRE(monitor3.get_counters().done);
+        REQUIRE(sema._debug_get_counter() == 0);
+        REQUIRE(sema._debug_get_awaiters().empty());
+    }
+    SECTION("FIFO order") {
+        counting_semaphore sema(0);
+        auto monitor1 = coro(sema, 3);
+        auto monitor2 = coro(sema, 1);
+        sema.release(1);
+        REQUIRE(!monitor1.get_counters().done);
+        REQUIRE(!monitor2.get_counters().done);
+        REQUIRE(!sema.try_acquire(1));
+        sema.release(2);
+        REQUIRE(monitor1.get_counters().done);
+        REQUIRE(!monitor2.get_counters().done);
+        sema.release(1);
+        REQUIRE(monitor2.get_counters().done);
+    }
+    SECTION("cancel front") {
+        static const auto cancellable = [](counting_semaphore& sema, ptrdiff_t count) -> task<void> {
+            co_await sema.acquire(count);
+        };
+        counting_semaphore sema(2);
+        std::stop_source source;
+        auto t1 = cancellable(sema, 4);
+        t1.set_stop_token(source.get_token());
+        t1.launch();
+        auto monitor = coro(sema, 2);
+        REQUIRE(!monitor.get_counters().done);
+        source.request_stop();
+        REQUIRE_THROWS_AS(join(t1), operation_cancelled);
+        REQUIRE(monitor.get_counters().done);
+        REQUIRE(sema._debug_get_counter() == 0);
+        REQUIRE(sema._debug_get_awaiters().empty());
+    }
+}
+
+TEST_CASE("Semaphore - cancel while woken", "[Semaphore]") {
+    static const auto cancellable = [](counting_semaphore& sema) -> task<void> {
+        co_await sema;
+    };
+
+    SECTION("stop requested by an earlier awaiter") {
+        static const auto stopper = [](counting_semaphore& sema, std::stop_source& source) -> task<void> {
+            co_await sema;
+            source.request_stop();
+        };
+        counting_semaphore sema(0);
+        std::stop_source source;
+        auto t1 = stopper(sema, source);
+        auto t2 = cancellable(sema);
+        auto t3 = cancellable(sema);
+        t1.launch();
+        t2.set_stop_token(source.get_token());
+        t2.launch();
+        t3.set_stop_token(source.get_token());
+        t3.launch();
+        // The stop request arrives while `t2` and `t3` have been granted their units, but have not been resumed yet.
+        sema.release(3);
+        join(t1);
+        join(t2);
+        join(t3);
+        REQUIRE(sema._debug_get_counter() == 0);
+        REQUIRE(sema._debug_get_awaiters().empty());
+    }
+    SECTION("multiple threads") {
+        static constexpr int num_tasks = 8;
+        static constexpr int num_iterations = 200;
+        thread_pool pool(4);
+        for (int i = 0; i < num_iterations; ++i) {
+            counting_semaphore sema(0);
+            std::stop_source source;
+            std::vector<task<void>> tasks;
+            for (int j = 0; j < num_tasks; ++j) {
+                auto t = cancellable(sema);
+                t.set_stop_token(source.get_token());
+                tasks.push_back(launch(std::move(t), pool));
+            }
+            std::thread stopper([&source] { source.request_stop(); });
+            sema.release(num_tasks);
+            stopper.join();
+            ptrdiff_t num_cancelled = 0;
+            for (auto& t : tasks) {
+                try {
+                    join(t);
+                }
+                catch (operation_cancelled&) {
+                    ++num_cancelled;
+                }
+            }
+            // The units of cancelled awaiters are not lost.
+            REQUIRE(sema._debug_get_counter() == num_cancelled);
+            REQUIRE(sema._debug_get_awaiters().empty());
+        }
+    }
+}
\ No newline at end of file
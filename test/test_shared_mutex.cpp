@@ -296,4 +296,202 @@ TEST_CASE("Shared mutex: shared lock destructor", "[Shared mutex]") {
     }
 
     REQUIRE(!mtx._debug_is_shared_locked());
+}
+
+TEST_CASE("Shared mutex: policies", "[Shared mutex]") {
+    SECTION("fifo") {
+        shared_mutex mtx(shared_mutex_policy::fifo);
+        REQUIRE(mtx.try_lock_shared());
+        auto writer = lock_exclusively(mtx);
+        REQUIRE(!mtx.try_lock_shared());
+        auto reader = lock_shared(mtx);
+        REQUIRE(!reader.get_counters().done);
+        mtx.unlock_shared();
+        REQUIRE(writer.get_counters().done);
+        REQUIRE(!reader.get_counters().done);
+        mtx.unlock();
+        REQUIRE(reader.get_counters().done);
+        mtx.unlock_shared();
+    }
+    SECTION("reader preferring") {
+        shared_mutex mtx(shared_mutex_policy::reader_preferring);
+        REQUIRE(mtx.try_lock_shared());
+        auto writer = lock_exclusively(mtx);
+        REQUIRE(!writer.get_counters().done);
+        auto reader = lock_shared(mtx);
+        REQUIRE(reader.get_counters().done);
+        mtx.unlock_shared();
+        REQUIRE(!writer.get_counters().done);
+        mtx.unlock_shared();
+        REQUIRE(writer.get_counters().done);
+        mtx.unlock();
+    }
+    SECTION("reader preferring - readers go first") {
+        shared_mutex mtx(shared_mutex_policy::reader_preferring);
+        REQUIRE(mtx.try_lock());
+        auto writer = lock_exclusively(mtx);
+        auto reader = lock_shared(mtx);
+        mtx.unlock();
+        REQUIRE(reader.get_counters().done);
+        REQUIRE(!writer.get_counters().done);
+        mtx.unlock_shared();
+        REQUIRE(writer.get_counters().done);
+        mtx.unlock();
+    }
+    SECTION("writer preferring") {
+        shared_mutex mtx(shared_mutex_policy::writer_preferring);
+        REQUIRE(mtx.try_lock());
+        auto reader = lock_shared(mtx);
+        auto writer1 = lock_exclusively(mtx);
+        auto writer2 = lock_exclusively(mtx);
+        mtx.unlock();
+        REQUIRE(writer1.get_counters().done);
+        REQUIRE(!reader.get_counters().done);
+        mtx.unlock();
+        REQUIRE(writer2.get_counters().done);
+        REQUIRE(!reader.get_counters().done);
+        mtx.unlock();
+        REQUIRE(reader.get_counters().done);
+        mtx.unlock_shared();
+    }
+    SECTION("phase fair") {
+        shared_mutex mtx(shared_mutex_policy::phase_fair);
+        REQUIRE(mtx.try_lock());
+        auto reader1 = lock_shared(mtx);
+        auto writer1 = lock_exclusively(mtx);
+        auto writer2 = lock_exclusively(mtx);
+        auto reader2 = lock_shared(mtx);
+        mtx.unlock();
+        REQUIRE(reader1.get_counters().done);
+        REQUIRE(reader2.get_counters().done);
+        REQUIRE(!writer1.get_counters().done);
+        REQUIRE(mtx._debug_is_shared_locked() == 2);
+        auto reader3 = lock_shared(mtx);
+        REQUIRE(!reader3.get_counters().done);
+        mtx.unlock_shared();
+        mtx.unlock_shared();
+        REQUIRE(writer1.get_counters().done);
+        mtx.unlock();
+        REQUIRE(reader3.get_counters().done);
+        REQUIRE(!writer2.get_counters().done);
+        mtx.unlock_shared();
+        REQUIRE(writer2.get_counters().done);
+        mtx.unlock();
+    }
+}
+
+static monitor_task lock_upgradable(shared_mutex& mtx) {
+    co_await mtx.upgradable();
+}
+
+
+static monitor_task upgrade(shared_mutex& mtx) {
+    co_await mtx.upgrade();
+}
+
+
+TEST_CASE("Shared mutex: upgradable", "[Shared mutex]") {
+    shared_mutex mtx;
+    shmtx_scope_clear guard(mtx);
+
+    SECTION("coexists with shared") {
+        REQUIRE(mtx.try_lock_shared());
+        REQUIRE(mtx.try_lock_upgradable());
+        REQUIRE(mtx.try_lock_shared());
+        REQUIRE(mtx._debug_is_upgradable_locked());
+        REQUIRE(mtx._debug_is_shared_locked() == 2);
+    }
+    SECTION("excludes exclusive") {
+        REQUIRE(mtx.try_lock_upgradable());
+        REQUIRE(!mtx.try_lock());
+        mtx.unlock_upgradable();
+        REQUIRE(mtx.try_lock());
+        REQUIRE(!mtx.try_lock_upgradable());
+    }
+    SECTION("excludes upgradable") {
+        REQUIRE(mtx.try_lock_upgradable());
+        REQUIRE(!mtx.try_lock_upgradable());
+        auto monitor = lock_upgradable(mtx);
+        REQUIRE(!monitor.get_counters().done);
+        mtx.unlock_upgradable();
+        REQUIRE(monitor.get_counters().done);
+        REQUIRE(mtx._debug_is_upgradable_locked());
+    }
+    SECTION("upgrade immediate") {
+        REQUIRE(mtx.try_lock_upgradable());
+        auto monitor = upgrade(mtx);
+        REQUIRE(monitor.get_counters().done);
+        REQUIRE(mtx._debug_is_exclusive_locked());
+        REQUIRE(!mtx._debug_is_upgradable_locked());
+    }
+    SECTION("upgrade waits for readers") {
+        REQUIRE(mtx.try_lock_shared());
+        REQUIRE(mtx.try_lock_upgradable());
+        REQUIRE(!mtx.try_upgrade());
+        auto monitor = upgrade(mtx);
+        REQUIRE(!monitor.get_counters().done);
+        REQUIRE(!mtx.try_lock_shared());
+        auto reader = lock_shared(mtx);
+        mtx.unlock_shared();
+        REQUIRE(monitor.get_counters().done);
+        REQUIRE(mtx._debug_is_exclusive_locked());
+        REQUIRE(!reader.get_counters().done);
+        mtx.unlock();
+        REQUIRE(reader.get_counters().done);
+    }
+    SECTION("upgrade before waiting writer") {
+        REQUIRE(mtx.try_lock_shared());
+        REQUIRE(mtx.try_lock_upgradable());
+        auto writer = lock_exclusively(mtx);
+        auto monitor = upgrade(mtx);
+        mtx.unlock_shared();
+        REQUIRE(monitor.get_counters().done);
+        REQUIRE(!writer.get_counters().done);
+        mtx.unlock();
+        REQUIRE(writer.get_counters().done);
+    }
+    SECTION("waiting after exclusive") {
+        REQUIRE(mtx.try_lock());
+        auto monitor = lock_upgradable(mtx);
+        auto reader = lock_shared(mtx);
+        REQUIRE(!monitor.get_counters().done);
+        mtx.unlock();
+        REQUIRE(monitor.get_counters().done);
+        REQUIRE(reader.get_counters().done);
+    }
+}
+
+
+TEST_CASE("Shared mutex: upgrade lock", "[Shared mutex]") {
+    shared_mutex mtx;
+    shmtx_scope_clear guard(mtx);
+
+    SECTION("try_lock") {
+        upgrade_lock lk(mtx, std::defer_lock);
+        REQUIRE(!lk.owns_lock());
+        lk.try_lock();
+        REQUIRE(lk.owns_lock());
+        REQUIRE(mtx._debug_is_upgradable_locked());
+    }
+    SECTION("destructor") {
+        {
+            upgrade_lock lk(mtx, std::defer_lock);
+            lk.try_lock();
+        }
+        REQUIRE(!mtx._debug_is_upgradable_locked());
+        REQUIRE(mtx.try_lock());
+    }
+    SECTION("upgrade") {
+        auto monitor = [](shared_mutex& mtx) -> monitor_task {
+            upgrade_lock ulk(co_await mtx.upgradable());
+            REQUIRE(ulk.owns_lock());
+            auto lk = co_await ulk.upgrade();
+            REQUIRE(!ulk.owns_lock());
+            REQUIRE(lk.owns_lock());
+            REQUIRE(mtx._debug_is_exclusive_locked());
+        }(mtx);
+        REQUIRE(monitor.get_counters().done);
+        REQUIRE(!mtx._debug_is_exclusive_locked());
+        REQUIRE(!mtx._debug_is_upgradable_locked());
+    }
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #include <asyncpp/join.hpp>
 #include <asyncpp/sleep.hpp>
 #include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+
+#include <optional>
+#include <thread>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -42,3 +47,131 @@ TEST_CASE("Sleep: sleep_until minimum timing", "[Sleep]") {
     const auto end = std::chrono::steady_clock::now();
     REQUIRE(end - start >= duration);
 }
+
+
+TEST_CASE("Sleep: cancel", "[Sleep]") {
+    static const auto coro = []() -> task<void> {
+        co_await sleep_for(1h);
+    };
+    std::stop_source source;
+    auto t = coro();
+    t.set_stop_token(source.get_token());
+    t.launch();
+    source.request_stop();
+    REQUIRE_THROWS_AS(join(t), operation_cancelled);
+}
+
+
+TEST_CASE("Sleep: cancel sleep until the end of time", "[Sleep]") {
+    static const auto coro = [](std::chrono::steady_clock::duration slack) -> task<void> {
+        co_await sleep_until(std::chrono::steady_clock::time_point::max(), slack);
+    };
+    std::chrono::steady_clock::duration slack(0);
+    SECTION("no slack") {}
+    SECTION("max slack") {
+        slack = std::chrono::steady_clock::duration::max();
+    }
+    std::stop_source source;
+    auto t = coro(slack);
+    t.set_stop_token(source.get_token());
+    t.launch();
+    REQUIRE(!t.ready());
+    source.request_stop();
+    REQUIRE_THROWS_AS(join(t), operation_cancelled);
+}
+
+
+TEST_CASE("Sleep: thread pool timers", "[Sleep]") {
+    thread_pool pool(2);
+    std::atomic_int count = 0;
+    const auto delayed = [&count](std::chrono::milliseconds duration) -> task<void> {
+        const auto start = std::chrono::steady_clock::now();
+        co_await sleep_for(duration);
+        co_await sleep_for(duration);
+        if (std::chrono::steady_clock::now() - start >= 2 * duration) {
+            ++count;
+        }
+    };
+
+    std::vector<task<void>> tasks;
+    for (int i = 0; i < 8; ++i) {
+        tasks.push_back(launch(delayed(std::chrono::milliseconds(i)), pool));
+    }
+    for (auto& t : tasks) {
+        join(t);
+    }
+    REQUIRE(count == 8);
+}
+
+
+TEST_CASE("Sleep: thread pool cancel", "[Sleep]") {
+    thread_pool pool(1);
+    static const auto coro = []() -> task<void> {
+        co_await sleep_for(1h);
+    };
+    std::stop_source source;
+    auto t = coro();
+    t.set_stop_token(source.get_token());
+    t.bind(pool);
+    t.launch();
+    source.request_stop();
+    REQUIRE_THROWS_AS(join(t), operation_cancelled);
+}
+
+TEST_CASE("Sleep: cancel while the thread pool shuts down", "[Sleep]") {
+    static const auto coro = []() -> task<void> {
+        co_await sleep_for(1h);
+    };
+    // The sleeping tasks aren't bound to the pool, but they go to sleep on its workers.
+    const auto start = [](std::vector<task<void>>& tasks, std::stop_token token) -> task<void> {
+        for (auto& t : tasks) {
+            t = coro();
+            t.set_stop_token(token);
+            t.launch();
+        }
+        co_return;
+    };
+
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        std::stop_source source;
+        std::vector<task<void>> tasks(8);
+        std::optional<thread_pool> pool(std::in_place, 2);
+        join(launch(start(tasks, source.get_token()), *pool));
+
+        std::jthread stopper([&source] { source.request_stop(); });
+        pool.reset();
+        stopper.join();
+        for (auto& t : tasks) {
+            REQUIRE_THROWS_AS(join(t), operation_cancelled);
+        }
+    }
+}
+
+
+TEST_CASE("Sleep: coalesce", "[Sleep]") {
+    using impl_sleep::coalesce;
+    SECTION("no slack") {
+        REQUIRE(coalesce(13, 13, 1) == 13);
+    }
+    SECTION("most aligned in window") {
+        REQUIRE(coalesce(13, 20, 1) == 16);
+        REQUIRE(coalesce(17, 40, 1) == 32);
+        REQUIRE(coalesce(31, 33, 1) == 32);
+    }
+    SECTION("overlapping windows fire together") {
+        REQUIRE(coalesce(1001, 1100, 1) == coalesce(1010, 1050, 1));
+    }
+    SECTION("granularity") {
+        REQUIRE(coalesce(13, 13, 10) == 20);
+        REQUIRE(coalesce(20, 20, 10) == 20);
+    }
+}
+
+
+TEST_CASE("Sleep: slack minimum timing", "[Sleep]") {
+    const auto duration = 10ms;
+    const auto start = std::chrono::steady_clock::now();
+    join(sleep_for(duration, 20ms));
+    const auto end = std::chrono::steady_clock::now();
+    REQUIRE(end - start >= duration);
+}
\ No newline at end of file
@@ -2,10 +2,17 @@
 #include "monitor_allocator.hpp"
 #include "monitor_task.hpp"
 
+#include <asyncpp/event.hpp>
 #include <asyncpp/join.hpp>
 #include <asyncpp/stream.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
 #include <testing/interleaver.hpp>
 
+#include <array>
+#include <span>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
 
@@ -296,4 +303,176 @@ TEST_CASE("Stream: item const arrow", "[Stream]") {
     };
     const impl_stream::item<data> item(data{ 1 });
     REQUIRE(item->value == 1);
+}
+
+
+TEST_CASE("Stream: stop token inherited", "[Stream]") {
+    static const auto producer = [](event<int>& evt) -> stream<int> {
+        co_yield co_await evt;
+    };
+    static const auto consumer = [](event<int>& evt) -> task<void> {
+        auto s = producer(evt);
+        while (co_await s) {
+        }
+    };
+    event<int> evt;
+    std::stop_source source;
+    auto t = consumer(evt);
+    t.set_stop_token(source.get_token());
+    t.launch();
+    REQUIRE(!t.ready());
+    source.request_stop();
+    REQUIRE(t.ready());
+    REQUIRE_THROWS_AS(join(t), operation_cancelled);
+}
+
+
+TEST_CASE("Stream: buffered", "[Stream]") {
+    static const auto producer = [](int count, int& produced) -> stream<int> {
+        for (int i = 0; i < count; ++i) {
+            ++produced;
+            co_yield i;
+        }
+    };
+    static const auto consumer = [](stream<int>& s) -> task<std::vector<int>> {
+        std::vector<int> values;
+        while (const auto item = co_await s) {
+            values.push_back(*item);
+        }
+        co_return values;
+    };
+
+    SECTION("runs ahead") {
+        int produced = 0;
+        auto s = producer(10, produced);
+        s.set_buffer_size(4);
+        s.launch();
+        REQUIRE(produced == 4);
+        REQUIRE(s.ready());
+        REQUIRE(join(consumer(s)) == std::vector{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 });
+        REQUIRE(produced == 10);
+    }
+    SECTION("shorter than buffer") {
+        int produced = 0;
+        auto s = producer(2, produced);
+        s.set_buffer_size(4);
+        REQUIRE(join(consumer(s)) == std::vector{ 0, 1 });
+    }
+    SECTION("exception") {
+        static const auto coro = []() -> stream<int> {
+            co_yield 1;
+            throw std::runtime_error("test");
+        };
+        auto s = coro();
+        s.set_buffer_size(4);
+        auto r = [](stream<int>& s) -> monitor_task {
+            const auto first = co_await s;
+            REQUIRE(*first == 1);
+            REQUIRE_THROWS_AS(co_await s, std::runtime_error);
+            const auto last = co_await s;
+            REQUIRE(!last);
+        }(s);
+        REQUIRE(r.get_counters().done);
+    }
+    SECTION("thread pool") {
+        thread_pool pool(2);
+        int produced = 0;
+        auto s = producer(1000, produced);
+        s.set_buffer_size(16);
+        s.bind(pool);
+        const auto values = join(consumer(s));
+        REQUIRE(values.size() == 1000);
+        REQUIRE(std::ranges::is_sorted(values));
+    }
+    SECTION("cancel") {
+        static const auto waiting = [](event<int>& evt) -> stream<int> {
+            co_yield co_await evt;
+        };
+        static const auto coro = [](stream<int>& s) -> task<void> {
+            co_await s;
+        };
+        event<int> evt;
+        auto s = waiting(evt);
+        s.set_buffer_size(4);
+        std::stop_source source;
+        auto t = coro(s);
+        t.set_stop_token(source.get_token());
+        t.launch();
+        REQUIRE(!t.ready());
+        source.request_stop();
+        REQUIRE_THROWS_AS(join(t), operation_cancelled);
+        evt.set_value(1);
+    }
+}
+
+
+TEST_CASE("Stream: chunks", "[Stream]") {
+    SECTION("yield span") {
+        static const auto producer = []() -> stream<std::span<const int>> {
+            std::vector<int> chunk;
+            for (int i = 0; i < 3; ++i) {
+                chunk = { 3 * i, 3 * i + 1, 3 * i + 2 };
+                co_yield std::span<const int>(chunk);
+            }
+        };
+        static const auto consumer = []() -> task<std::vector<int>> {
+            auto s = producer();
+            std::vector<int> values;
+            while (const auto chunk = co_await s) {
+                values.insert(values.end(), chunk->begin(), chunk->end());
+            }
+            co_return values;
+        };
+        REQUIRE(join(consumer()) == std::vector{ 0, 1, 2, 3, 4, 5, 6, 7, 8 });
+    }
+    SECTION("rechunk") {
+        static const auto producer = [](int count) -> stream<int> {
+            for (int i = 0; i < count; ++i) {
+                co_yield i;
+            }
+        };
+        static const auto consumer = [](int count, size_t size) -> task<std::vector<std::vector<int>>> {
+            auto s = rechunk(producer(count), size);
+            std::vector<std::vector<int>> chunks;
+            while (auto chunk = co_await s) {
+                chunks.push_back(std::move(*chunk));
+            }
+            co_return chunks;
+        };
+        REQUIRE(join(consumer(10, 3)) == std::vector<std::vector<int>>{ { 0, 1, 2 }, { 3, 4, 5 }, { 6, 7, 8 }, { 9 } });
+        REQUIRE(join(consumer(4, 2)) == std::vector<std::vector<int>>{ { 0, 1 }, { 2, 3 } });
+        REQUIRE(join(consumer(0, 2)).empty());
+    }
+    SECTION("rechunk references") {
+        static std::array<int, 3> values = { 1, 2, 3 };
+        static const auto producer = []() -> stream<int&> {
+            for (auto& value : values) {
+                co_yield value;
+            }
+        };
+        static const auto consumer = []() -> task<std::vector<int>> {
+            auto s = rechunk(producer(), 5);
+            const auto chunk = co_await s;
+            co_return *chunk;
+        };
+        REQUIRE(join(consumer()) == std::vector{ 1, 2, 3 });
+    }
+    SECTION("rechunk reused reference") {
+        static const auto producer = []() -> stream<int&> {
+            int value = 0;
+            for (int i = 0; i < 7; ++i) {
+                value = i;
+                co_yield value;
+            }
+        };
+        static const auto consumer = []() -> task<std::vector<std::vector<int>>> {
+            auto s = rechunk(producer(), 3);
+            std::vector<std::vector<int>> chunks;
+            while (auto chunk = co_await s) {
+                chunks.push_back(std::move(*chunk));
+            }
+            co_return chunks;
+        };
+        REQUIRE(join(consumer()) == std::vector<std::vector<int>>{ { 0, 1, 2 }, { 3, 4, 5 }, { 6 } });
+    }
 }
\ No newline at end of file
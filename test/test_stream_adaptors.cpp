@@ -0,0 +1,235 @@
+#include <asyncpp/event.hpp>
+#include <asyncpp/join.hpp>
+#include <asyncpp/stream_adaptors.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+
+using namespace asyncpp;
+
+
+static stream<int> iota(int count) {
+    for (int i = 0; i < count; ++i) {
+        co_yield i;
+    }
+}
+
+
+static task<std::vector<int>> collect(stream<int> s) {
+    std::vector<int> values;
+    for (auto it = co_await s.begin(); it != s.end(); co_await ++it) {
+        values.push_back(*it);
+    }
+    co_return values;
+}
+
+
+TEST_CASE("Stream adaptors: iterator", "[Stream adaptors]") {
+    SECTION("empty") {
+        REQUIRE(join(collect(iota(0))).empty());
+    }
+    SECTION("values") {
+        REQUIRE(join(collect(iota(4))) == std::vector{ 0, 1, 2, 3 });
+    }
+    SECTION("arrow") {
+        static const auto coro = []() -> task<size_t> {
+            auto s = []() -> stream<std::string> { co_yield "abc"; }();
+            auto it = co_await s.begin();
+            co_return it->size();
+        };
+        REQUIRE(join(coro()) == 3);
+    }
+}
+
+
+TEST_CASE("Stream adaptors: transform", "[Stream adaptors]") {
+    SECTION("same type") {
+        stream<int> s = iota(3) | transform([](int value) { return value * 10; });
+        REQUIRE(join(collect(std::move(s))) == std::vector{ 0, 10, 20 });
+    }
+    SECTION("different type") {
+        static const auto coro = []() -> task<std::string> {
+            stream<std::string> s = iota(3) | transform([](int value) { return std::to_string(value); });
+            std::string result;
+            while (const auto item = co_await s) {
+                result += *item;
+            }
+            co_return result;
+        };
+        REQUIRE(join(coro()) == "012");
+    }
+}
+
+
+TEST_CASE("Stream adaptors: filter", "[Stream adaptors]") {
+    stream<int> s = iota(10) | filter([](int value) { return value % 3 == 0; });
+    REQUIRE(join(collect(std::move(s))) == std::vector{ 0, 3, 6, 9 });
+}
+
+
+TEST_CASE("Stream adaptors: take", "[Stream adaptors]") {
+    SECTION("fewer") {
+        stream<int> s = iota(10) | take(3);
+        REQUIRE(join(collect(std::move(s))) == std::vector{ 0, 1, 2 });
+    }
+    SECTION("more") {
+        stream<int> s = iota(2) | take(3);
+        REQUIRE(join(collect(std::move(s))) == std::vector{ 0, 1 });
+    }
+    SECTION("none") {
+        stream<int> s = iota(2) | take(0);
+        REQUIRE(join(collect(std::move(s))).empty());
+    }
+    SECTION("source reads") {
+        static const auto counted = [](int& num_resumed) -> stream<int> {
+            for (int i = 0; i < 10; ++i) {
+                ++num_resumed;
+                co_yield i;
+            }
+        };
+        int num_resumed = 0;
+        size_t count = 0;
+        SECTION("zero") {}
+        SECTION("some") {
+            count = 3;
+        }
+        stream<int> s = counted(num_resumed) | take(count);
+        REQUIRE(join(collect(std::move(s))).size() == count);
+        REQUIRE(num_resumed == int(count));
+    }
+    SECTION("infinite") {
+        static const auto naturals = []() -> stream<int> {
+            int value = 0;
+            while (true) {
+                co_yield value++;
+            }
+        };
+        stream<int> s = naturals() | take(2);
+        REQUIRE(join(collect(std::move(s))) == std::vector{ 0, 1 });
+    }
+}
+
+
+TEST_CASE("Stream adaptors: pipeline", "[Stream adaptors]") {
+    stream<int> s = iota(100)
+                    | filter([](int value) { return value % 2 == 1; })
+                    | transform([](int value) { return value * value; })
+                    | take(4);
+    REQUIRE(join(collect(std::move(s))) == std::vector{ 1, 9, 25, 49 });
+}
+
+
+TEST_CASE("Stream adaptors: merge", "[Stream adaptors]") {
+    SECTION("inline") {
+        auto values = join(collect(merge(iota(3), iota(5), iota(0))));
+        std::ranges::sort(values);
+        REQUIRE(values == std::vector{ 0, 0, 1, 1, 2, 2, 3, 4 });
+    }
+    SECTION("thread pool") {
+        thread_pool pool(2);
+        auto s1 = iota(100);
+        auto s2 = iota(100);
+        s1.bind(pool);
+        s2.bind(pool);
+        const auto values = join(collect(merge(std::move(s1), std::move(s2))));
+        REQUIRE(values.size() == 200);
+    }
+    SECTION("exception") {
+        static const auto failing = []() -> stream<int> {
+            co_yield 1;
+            throw std::runtime_error("test");
+        };
+        REQUIRE_THROWS_AS(join(collect(merge(iota(2), failing()))), std::runtime_error);
+    }
+    SECTION("abandon") {
+        static const auto naturals = []() -> stream<int> {
+            int value = 0;
+            while (true) {
+                co_yield value++;
+            }
+        };
+        stream<int> s = merge(naturals(), naturals()) | take(5);
+        REQUIRE(join(collect(std::move(s))).size() == 5);
+    }
+    SECTION("abandon with idle source") {
+        // The source has a stop token of its own, so only its pump is stopped when the merged stream is destroyed.
+        static const auto idle = [](event<void>& evt, int& num_pulled) -> stream<int> {
+            co_await evt;
+            co_yield 1;
+            ++num_pulled;
+        };
+        static const auto first = [](stream<int> s) -> task<int> {
+            co_return *co_await s;
+        };
+        std::stop_source own;
+        event<void> evt;
+        int num_pulled = 0;
+        auto s = idle(evt, num_pulled);
+        s.set_stop_token(own.get_token());
+        REQUIRE(join(first(merge(iota(1), std::move(s)))) == 0);
+        evt.set_value();
+        REQUIRE(num_pulled == 0);
+    }
+}
+
+TEST_CASE("Stream adaptors: parallel_map", "[Stream adaptors]") {
+    thread_pool pool(4);
+    std::atomic_size_t running = 0;
+    std::atomic_size_t max_running = 0;
+    const auto square = [&](int value) {
+        const auto count = ++running;
+        size_t expected = max_running.load();
+        while (expected < count && !max_running.compare_exchange_weak(expected, count)) {
+        }
+        --running;
+        return value * value;
+    };
+    std::vector<int> squares(100);
+    for (int i = 0; i < 100; ++i) {
+        squares[i] = i * i;
+    }
+
+    SECTION("ordered") {
+        REQUIRE(join(collect(parallel_map(iota(100), square, pool, 8))) == squares);
+        REQUIRE(max_running <= 8);
+    }
+    SECTION("unordered") {
+        auto values = join(collect(parallel_map_unordered(iota(100), square, pool, 8)));
+        std::ranges::sort(values);
+        REQUIRE(values == squares);
+        REQUIRE(max_running <= 8);
+    }
+    SECTION("exception") {
+        static const auto failing = [](int value) -> int {
+            if (value == 50) {
+                throw std::runtime_error("test");
+            }
+            return value;
+        };
+        REQUIRE_THROWS_AS(join(collect(parallel_map(iota(100), failing, pool, 8))), std::runtime_error);
+        REQUIRE_THROWS_AS(join(collect(parallel_map_unordered(iota(100), failing, pool, 8))), std::runtime_error);
+    }
+    SECTION("exception unordered") {
+        static const auto failing = [](int) -> int {
+            throw std::runtime_error("test");
+        };
+        REQUIRE_THROWS_AS(join(collect(parallel_map_unordered(iota(100), failing, pool, 8))), std::runtime_error);
+        REQUIRE_THROWS_AS(join(collect(parallel_map_unordered(iota(1), failing, pool, 8))), std::runtime_error);
+    }
+    SECTION("abandon") {
+        stream<int> s = parallel_map(iota(100), square, pool, 8) | take(5);
+        REQUIRE(join(collect(std::move(s))) == std::vector{ 0, 1, 4, 9, 16 });
+    }
+    SECTION("abandon unordered") {
+        stream<int> s = parallel_map_unordered(iota(100), square, pool, 8) | take(5);
+        REQUIRE(join(collect(std::move(s))).size() == 5);
+    }
+}
\ No newline at end of file
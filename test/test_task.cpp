@@ -1,10 +1,16 @@
 #include "helper_schedulers.hpp"
 #include "monitor_allocator.hpp"
 
+#include <asyncpp/event.hpp>
 #include <asyncpp/join.hpp>
 #include <asyncpp/task.hpp>
 #include <asyncpp/testing/interleaver.hpp>
 
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
 #include <catch2/catch_template_test_macros.hpp>
 #include <catch2/catch_test_macros.hpp>
 
@@ -249,4 +255,163 @@ TEMPLATE_TEST_CASE("Task: allocator explicit", "[Task]", (task<monitor_allocator
         REQUIRE(alloc.get_num_allocations() == 1);
         REQUIRE(alloc.get_num_live_objects() == 0);
     }
+}
+
+struct stateless_allocator_counters {
+    inline static size_t num_allocated_bytes = 0;
+    inline static size_t num_deallocated_bytes = 0;
+};
+
+
+template <class T = std::byte>
+struct stateless_allocator : stateless_allocator_counters {
+    using value_type = T;
+
+    stateless_allocator() = default;
+
+    template <class U>
+    stateless_allocator(const stateless_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        num_allocated_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        num_deallocated_bytes += n * sizeof(T);
+        return std::allocator<T>().deallocate(ptr, n);
+    }
+};
+
+
+struct stateful_allocator_counters {
+    inline static size_t num_allocated_bytes = 0;
+};
+
+
+// Same as the stateless allocator, but its state takes exactly one more block of the frame.
+template <class T = std::byte>
+struct stateful_allocator : stateful_allocator_counters {
+    using value_type = T;
+
+    stateful_allocator() = default;
+
+    template <class U>
+    stateful_allocator(const stateful_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        num_allocated_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        return std::allocator<T>().deallocate(ptr, n);
+    }
+
+    std::array<std::byte, alignof(std::max_align_t)> m_state = {};
+};
+
+template <class T, class U>
+bool operator==(const stateful_allocator<T>&, const stateful_allocator<U>&) noexcept {
+    return true;
+}
+
+
+TEMPLATE_TEST_CASE("Task: allocator stateless", "[Task]", (task<int, stateless_allocator<>>), (shared_task<int, stateless_allocator<>>)) {
+    static_assert(std::is_empty_v<stateless_allocator<>>);
+    static const auto coro = []() -> TestType {
+        co_return 1;
+    };
+
+    stateless_allocator_counters::num_allocated_bytes = 0;
+    stateless_allocator_counters::num_deallocated_bytes = 0;
+    {
+        auto task = coro();
+        REQUIRE(join(task) == 1);
+    }
+    REQUIRE(stateless_allocator_counters::num_allocated_bytes > 0);
+    REQUIRE(stateless_allocator_counters::num_allocated_bytes == stateless_allocator_counters::num_deallocated_bytes);
+}
+
+
+template <size_t Size, class Alloc>
+task<int, Alloc> sized_frame() {
+    std::array<std::byte, Size> data = {};
+    co_await std::suspend_never{};
+    co_return static_cast<int>(data.size());
+}
+
+
+template <size_t Size>
+bool stateless_frame_smaller() {
+    stateless_allocator_counters::num_allocated_bytes = 0;
+    stateful_allocator_counters::num_allocated_bytes = 0;
+    join(sized_frame<Size, stateless_allocator<>>());
+    join(sized_frame<Size, stateful_allocator<>>());
+    return stateless_allocator_counters::num_allocated_bytes < stateful_allocator_counters::num_allocated_bytes;
+}
+
+
+TEST_CASE("Task: allocator stateless frame size", "[Task]") {
+    static_assert(!std::allocator_traits<stateful_allocator<>>::is_always_equal::value);
+    // A stored allocator would only be hidden by the padding for some of the frame sizes.
+    const auto smaller = []<size_t... Sizes>(std::index_sequence<Sizes...>) {
+        return (... && stateless_frame_smaller<Sizes + 1>());
+    };
+    REQUIRE(smaller(std::make_index_sequence<2 * alignof(std::max_align_t)>()));
+}
+
+
+TEMPLATE_TEST_CASE("Task: stop token inherited", "[Task]", task<int>, shared_task<int>) {
+    static const auto child = [](event<int>& evt) -> TestType {
+        co_return co_await evt;
+    };
+    static const auto parent = [](event<int>& evt) -> task<int> {
+        co_return co_await child(evt);
+    };
+    event<int> evt;
+    std::stop_source source;
+    auto t = parent(evt);
+    t.set_stop_token(source.get_token());
+    t.launch();
+    REQUIRE(!t.ready());
+    source.request_stop();
+    REQUIRE(t.ready());
+    REQUIRE_THROWS_AS(join(t), operation_cancelled);
+}
+
+
+TEST_CASE("Task: get stop token", "[Task]") {
+    static const auto child = []() -> task<std::stop_token> {
+        co_return co_await get_stop_token();
+    };
+    static const auto parent = []() -> task<std::stop_token> {
+        co_return co_await child();
+    };
+    SECTION("no token") {
+        REQUIRE(!join(parent()).stop_possible());
+    }
+    SECTION("inherited") {
+        std::stop_source source;
+        auto t = parent();
+        t.set_stop_token(source.get_token());
+        const auto token = join(t);
+        REQUIRE(token.stop_possible());
+        source.request_stop();
+        REQUIRE(token.stop_requested());
+    }
+    SECTION("own token") {
+        std::stop_source parent_source;
+        std::stop_source child_source;
+        static const auto enclosing = [](std::stop_token token) -> task<std::stop_token> {
+            auto c = child();
+            c.set_stop_token(std::move(token));
+            co_return co_await c;
+        };
+        auto t = enclosing(child_source.get_token());
+        t.set_stop_token(parent_source.get_token());
+        const auto token = join(t);
+        child_source.request_stop();
+        REQUIRE(token.stop_requested());
+    }
 }
\ No newline at end of file
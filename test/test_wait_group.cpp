@@ -0,0 +1,82 @@
+#include "monitor_task.hpp"
+
+#include <asyncpp/join.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+#include <asyncpp/wait_group.hpp>
+
+#include <atomic>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace asyncpp;
+
+
+static monitor_task wait(wait_group& wg) {
+    co_await wg;
+}
+
+
+TEST_CASE("Wait group: empty", "[Wait group]") {
+    wait_group wg;
+    auto monitor = wait(wg);
+    REQUIRE(monitor.get_counters().done);
+}
+
+
+TEST_CASE("Wait group: wait", "[Wait group]") {
+    wait_group wg;
+    wg.add(2);
+    auto monitor1 = wait(wg);
+    auto monitor2 = wait(wg);
+    wg.done();
+    REQUIRE(!monitor1.get_counters().done);
+    wg.done();
+    REQUIRE(monitor1.get_counters().done);
+    REQUIRE(monitor2.get_counters().done);
+    REQUIRE(wg._debug_get_counter() == 0);
+}
+
+
+TEST_CASE("Wait group: reuse", "[Wait group]") {
+    wait_group wg;
+    wg.add();
+    wg.done();
+    wg.add();
+    auto monitor = wait(wg);
+    REQUIRE(!monitor.get_counters().done);
+    wg.add();
+    wg.done();
+    REQUIRE(!monitor.get_counters().done);
+    wg.done();
+    REQUIRE(monitor.get_counters().done);
+}
+
+
+TEST_CASE("Wait group: multiple threads", "[Wait group]") {
+    static constexpr int num_tasks = 64;
+    static const auto work = [](wait_group& wg, std::atomic_int& finished) -> task<void> {
+        finished.fetch_add(1);
+        wg.done();
+        co_return;
+    };
+    static const auto wait_all = [](wait_group& wg, std::atomic_int& finished) -> task<int> {
+        co_await wg;
+        co_return finished.load();
+    };
+
+    thread_pool pool(4);
+    wait_group wg;
+    std::atomic_int finished = 0;
+    wg.add(num_tasks);
+    auto waiter = launch(wait_all(wg, finished), pool);
+    std::vector<task<void>> tasks;
+    for (int i = 0; i < num_tasks; ++i) {
+        tasks.push_back(launch(work(wg, finished), pool));
+    }
+    REQUIRE(join(waiter) == num_tasks);
+    for (auto& t : tasks) {
+        join(t);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "helper_schedulers.hpp"
+
+#include <asyncpp/event.hpp>
+#include <asyncpp/join.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+#include <asyncpp/when_all.hpp>
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+
+using namespace asyncpp;
+
+
+static task<int> value_coro(int value) {
+    co_return value;
+}
+
+
+static task<int> event_coro(event<int>& evt) {
+    co_return co_await evt;
+}
+
+
+TEST_CASE("When all: variadic", "[When all]") {
+    SECTION("values") {
+        const auto [a, b, c] = join(when_all(value_coro(1), value_coro(2), value_coro(3)));
+        REQUIRE(a == 1);
+        REQUIRE(b == 2);
+        REQUIRE(c == 3);
+    }
+    SECTION("mixed types") {
+        static const auto void_coro = []() -> task<void> { co_return; };
+        static const auto shared_coro = [](int value) -> shared_task<int> { co_return value; };
+        auto shared = shared_coro(3);
+        auto [a, b, c] = join(when_all(value_coro(1), void_coro(), shared));
+        REQUIRE(a == 1);
+        REQUIRE(b == nullptr);
+        REQUIRE(c.get() == 3);
+    }
+    SECTION("empty") {
+        const auto result = join(when_all());
+        REQUIRE(std::tuple_size_v<decltype(result)> == 0);
+    }
+}
+
+
+TEST_CASE("When all: range", "[When all]") {
+    SECTION("values") {
+        std::vector<task<int>> tasks;
+        for (int i = 0; i < 10; ++i) {
+            tasks.push_back(value_coro(i));
+        }
+        const auto results = join(when_all(tasks));
+        REQUIRE(results == std::vector{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 });
+    }
+    SECTION("empty") {
+        std::vector<task<int>> tasks;
+        const auto results = join(when_all(tasks));
+        REQUIRE(results.empty());
+    }
+}
+
+
+TEST_CASE("When all: exception", "[When all]") {
+    static const auto throwing_coro = []() -> task<int> {
+        throw std::runtime_error("test");
+        co_return 0;
+    };
+    REQUIRE_THROWS_AS(join(when_all(value_coro(1), throwing_coro())), std::runtime_error);
+}
+
+
+TEST_CASE("When all: waits for all", "[When all]") {
+    event<int> evt1;
+    event<int> evt2;
+    thread_locked_scheduler sched;
+
+    static const auto enclosing = [](event<int>& evt1, event<int>& evt2) -> task<int> {
+        const auto [a, b] = co_await when_all(event_coro(evt1), event_coro(evt2));
+        co_return a + b;
+    };
+
+    auto t = launch(enclosing(evt1, evt2), sched);
+    sched.resume();
+    REQUIRE(!t.ready());
+    evt2.set_value(2);
+    REQUIRE(!t.ready());
+    evt1.set_value(1);
+    REQUIRE(!t.ready());
+    sched.resume();
+    REQUIRE(t.ready());
+    REQUIRE(join(t) == 3);
+}
+
+
+TEST_CASE("When all: thread pool", "[When all]") {
+    static constexpr int count = 1000;
+    thread_pool pool(4);
+    std::vector<task<int>> tasks;
+    for (int i = 0; i < count; ++i) {
+        tasks.push_back(launch(value_coro(i), pool));
+    }
+    const auto results = join(when_all(tasks));
+    REQUIRE(results.size() == count);
+    for (int i = 0; i < count; ++i) {
+        REQUIRE(results[i] == i);
+    }
+}
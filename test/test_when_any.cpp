@@ -0,0 +1,135 @@
+#include "helper_schedulers.hpp"
+
+#include <asyncpp/event.hpp>
+#include <asyncpp/join.hpp>
+#include <asyncpp/task.hpp>
+#include <asyncpp/thread_pool.hpp>
+#include <asyncpp/when_any.hpp>
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+
+using namespace asyncpp;
+
+
+static task<int> event_coro(event<int>& evt) {
+    co_return co_await evt;
+}
+
+
+TEST_CASE("When any: variadic", "[When any]") {
+    event<int> evt1;
+    event<int> evt2;
+
+    static const auto enclosing = [](event<int>& evt1, event<int>& evt2) -> task<std::variant<int, int>> {
+        co_return co_await when_any(event_coro(evt1), event_coro(evt2));
+    };
+
+    auto t = launch(enclosing(evt1, evt2));
+    REQUIRE(!t.ready());
+    evt2.set_value(2);
+    REQUIRE(t.ready());
+    evt1.set_value(1);
+    const auto result = join(t);
+    REQUIRE(result.index() == 1);
+    REQUIRE(std::get<1>(result) == 2);
+}
+
+
+TEST_CASE("When any: already completed", "[When any]") {
+    static const auto value_coro = [](int value) -> task<int> { co_return value; };
+    event<int> evt;
+    const auto result = join(when_any(event_coro(evt), value_coro(2)));
+    REQUIRE(result.index() == 1);
+    REQUIRE(std::get<1>(result) == 2);
+    evt.set_value(1);
+}
+
+
+TEST_CASE("When any: range", "[When any]") {
+    std::vector<event<int>> events(4);
+    std::vector<task<int>> tasks;
+    for (auto& evt : events) {
+        tasks.push_back(event_coro(evt));
+    }
+
+    static const auto enclosing = [](std::vector<task<int>>& tasks) -> task<std::pair<size_t, int>> {
+        co_return co_await when_any(tasks);
+    };
+
+    auto t = launch(enclosing(tasks));
+    REQUIRE(!t.ready());
+    events[2].set_value(42);
+    REQUIRE(t.ready());
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (i != 2) {
+            events[i].set_value(int(i));
+        }
+    }
+    const auto [index, value] = join(t);
+    REQUIRE(index == 2);
+    REQUIRE(value == 42);
+}
+
+
+TEST_CASE("When any: exception", "[When any]") {
+    static const auto throwing_coro = []() -> task<int> {
+        throw std::runtime_error("test");
+        co_return 0;
+    };
+    event<int> evt;
+    REQUIRE_THROWS_AS(join(when_any(event_coro(evt), throwing_coro())), std::runtime_error);
+    evt.set_value(1);
+}
+
+
+TEST_CASE("When any: thread pool", "[When any]") {
+    static const auto value_coro = [](int value) -> task<int> { co_return value; };
+    thread_pool pool(4);
+    for (int rep = 0; rep < 100; ++rep) {
+        std::vector<task<int>> tasks;
+        for (int i = 0; i < 8; ++i) {
+            tasks.push_back(launch(value_coro(i), pool));
+        }
+        const auto [index, value] = join(when_any(tasks));
+        REQUIRE(int(index) == value);
+    }
+}
+
+
+TEST_CASE("When any: stops the rest", "[When any]") {
+    static const auto stoppable_coro = [](event<int>& evt, bool& stopped) -> task<int> {
+        try {
+            co_return co_await evt;
+        }
+        catch (operation_cancelled&) {
+            stopped = true;
+            throw;
+        }
+    };
+    static const auto value_coro = [](int value) -> task<int> { co_return value; };
+    event<int> evt;
+    bool stopped = false;
+    const auto result = join(when_any(stoppable_coro(evt, stopped), value_coro(2)));
+    REQUIRE(result.index() == 1);
+    REQUIRE(stopped);
+}
+
+
+TEST_CASE("When any: forwards stop", "[When any]") {
+    static const auto enclosing = [](event<int>& evt1, event<int>& evt2) -> task<std::variant<int, int>> {
+        co_return co_await when_any(event_coro(evt1), event_coro(evt2));
+    };
+    event<int> evt1;
+    event<int> evt2;
+    std::stop_source source;
+    auto t = enclosing(evt1, evt2);
+    t.set_stop_token(source.get_token());
+    t.launch();
+    REQUIRE(!t.ready());
+    source.request_stop();
+    REQUIRE(t.ready());
+    REQUIRE_THROWS_AS(join(t), operation_cancelled);
+}
\ No newline at end of file